@@ -38,14 +38,48 @@
 #include "stm32l0xx_ll_rng.h"
 
 #include "os.h"
+#include "hal_drivers.h"
 
 /* Exported variables --------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
+#define BOARD_SYSTICK_HZ            1000        // 1ms per tick
+
 /* Private typedef -----------------------------------------------------------*/
+typedef struct board_clock {
+    os_uint32_t hz;
+    os_uint32_t source;                     // LL_RCC_SYS_CLKSOURCE_*
+    os_uint32_t status;                     // LL_RCC_SYS_CLKSOURCE_STATUS_*
+    os_uint32_t msi_range;                  // LL_RCC_MSIRANGE_* for the MSI points
+    os_uint32_t latency;                    // LL_FLASH_LATENCY_*
+    os_uint32_t scale;                      // LL_PWR_REGU_VOLTAGE_SCALE*
+} board_clock_t;
+
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
+static volatile os_uint32_t board_tick;
+
+/* Clock points, fastest first. Range 2 allows 0 wait states up to 8 MHz
+   only, so HSI16 stays in range 1. Refer to RM0377, section 3.7.1. */
+static const board_clock_t board_clock[] = {
+    { 32000000, LL_RCC_SYS_CLKSOURCE_PLL, LL_RCC_SYS_CLKSOURCE_STATUS_PLL, 0,
+      LL_FLASH_LATENCY_1, LL_PWR_REGU_VOLTAGE_SCALE1 },     // HSI16 x 4 / 2
+    { 16000000, LL_RCC_SYS_CLKSOURCE_HSI, LL_RCC_SYS_CLKSOURCE_STATUS_HSI, 0,
+      LL_FLASH_LATENCY_0, LL_PWR_REGU_VOLTAGE_SCALE1 },
+    {  4194304, LL_RCC_SYS_CLKSOURCE_MSI, LL_RCC_SYS_CLKSOURCE_STATUS_MSI, LL_RCC_MSIRANGE_6,
+      LL_FLASH_LATENCY_0, LL_PWR_REGU_VOLTAGE_SCALE2 },
+    {  2097152, LL_RCC_SYS_CLKSOURCE_MSI, LL_RCC_SYS_CLKSOURCE_STATUS_MSI, LL_RCC_MSIRANGE_5,
+      LL_FLASH_LATENCY_0, LL_PWR_REGU_VOLTAGE_SCALE2 },
+};
+
+static os_uint8_t board_clock_point;
+static os_uint32_t board_systick_reload;    // HCLK / BOARD_SYSTICK_HZ
+static os_uint32_t board_cycle_base;        // keeps os_board_cycles() going across clock switches
+static os_uint32_t board_cycle_tick;
+
 /* Private function prototypes -----------------------------------------------*/
 static void SystemClock_Config( void );
+static void board_clock_switch( const board_clock_t *p_from, const board_clock_t *p_to );
+static void board_clock_scale( os_uint32_t scale );
 
 /* Exported function implementations -----------------------------------------*/
 
@@ -79,17 +113,27 @@ void os_assert_failed(char *file, os_uint32_t line)
 void SysTick_Handler(void);
 void SysTick_Handler(void)
 {
-    extern os_uint8_t os_systick;
+    extern volatile os_uint32_t os_systick;
+#ifdef OS_BUDGET_EN
+    extern void __os_budget_check( void );
+#endif
     os_systick++;
+    board_tick++;
+#ifdef OS_BUDGET_EN
+    __os_budget_check();
+#endif
 }
 #endif // (OS_TIMER_EN > 0)
 
 void os_board_init( void )
 {
     SystemClock_Config();
+    board_clock_point = 0;
+    board_systick_reload = board_clock[0].hz / BOARD_SYSTICK_HZ;
+    SystemCoreClock = board_clock[0].hz;
     
  #ifdef OS_CLOCK_EN
-    SysTick_Config( 32000 );
+    SysTick_Config( board_systick_reload );
  #endif
  
     LL_IOP_GRP1_EnableClock( LL_IOP_GRP1_PERIPH_GPIOA );
@@ -97,6 +141,9 @@ void os_board_init( void )
     LL_IOP_GRP1_EnableClock( LL_IOP_GRP1_PERIPH_GPIOC );
 
     NVIC_SetPriority(USART2_IRQn, 0);
+#ifdef OS_URGENT_EN
+    NVIC_SetPriority( PendSV_IRQn, OS_URGENT_PRIO );
+#endif
     //NVIC_SetPriority( I2C1_IRQn,      0 ); // Priority 0 (Highest)
     //NVIC_SetPriority( ADC1_COMP_IRQn, 3 ); // Priority 3 (Lowest)
     //NVIC_SetPriority( EXTI4_15_IRQn,  2 ); // Priority 2
@@ -115,6 +162,205 @@ void os_board_idle( void )
 
 }
 
+#ifdef OS_URGENT_EN
+/**
+  * @brief  Pends PendSV, which runs the urgent tasks at OS_URGENT_PRIO.
+  * @param  None
+  * @retval None
+  */
+void os_board_urgent_pend( void )
+{
+    SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+void PendSV_Handler(void);
+void PendSV_Handler(void)
+{
+    extern void __os_urgent_process( void );
+    __os_urgent_process();
+}
+#endif
+
+/**
+  * @brief  Free-running HCLK cycle count built from the SysTick period count
+  *         and the down-counter, wraps modulo 2^32. Cortex-M0+ has no DWT.
+  * @param  None
+  * @retval Cycle count
+  */
+os_uint32_t os_board_cycles( void )
+{
+    os_uint32_t tick;
+    os_uint32_t val;
+    os_uint32_t pending;
+
+    do
+    {
+        tick = board_tick;
+        val = SysTick->VAL;
+        pending = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
+    } while( tick != board_tick );
+
+    /* the counter reloaded but SysTick_Handler has not run yet */
+    if( pending && val > ( board_systick_reload >> 1 ) )
+    {
+        tick++;
+    }
+
+    return board_cycle_base + ( tick - board_cycle_tick ) * board_systick_reload +
+           ( board_systick_reload - 1 - val );
+}
+
+/**
+  * @brief  Core clock of a clock point.
+  * @param  point: 0 is the fastest
+  * @retval Frequency in Hz, 0 past the slowest point
+  */
+os_uint32_t os_board_clock_hz( os_uint8_t point )
+{
+    return ( point < sizeof(board_clock) / sizeof(board_clock[0]) ) ? board_clock[point].hz : 0;
+}
+
+os_uint8_t os_board_clock_get( void )
+{
+    return board_clock_point;
+}
+
+/**
+  * @brief  Moves the core to another clock point. SysTick keeps its 1ms
+  *         period, the partial tick is carried over scaled to the new clock,
+  *         and the UART baud rates are derived again. The UARTs send what
+  *         they hold first, the switch is left for later while one receives.
+  * @param  point: 0 is the fastest
+  * @retval OS_ERR_NONE, OS_ERR_BUSY if a UART kept the clock where it was
+  */
+os_err_t os_board_clock_set( os_uint8_t point )
+{
+    os_uint32_t reload;
+    os_uint32_t remain;
+    os_uint32_t cycles;
+
+    OS_ASSERT( point < sizeof(board_clock) / sizeof(board_clock[0]) );
+
+#ifdef OS_USING_HAL_UART
+    hal_uart_clock_drain();
+#endif
+
+    OS_ENTER_CRITICAL();
+    if( point == board_clock_point )
+    {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_NONE;
+    }
+
+#ifdef OS_USING_HAL_UART
+    if( !hal_uart_clock_begin() )
+    {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_BUSY;
+    }
+#endif
+    cycles = os_board_cycles();
+
+    board_clock_switch( &board_clock[board_clock_point], &board_clock[point] );
+    board_clock_point = point;
+    SystemCoreClock = board_clock[point].hz;
+
+    /* finish the current tick at the new rate, then reload the full period */
+    reload = board_clock[point].hz / BOARD_SYSTICK_HZ;
+    remain = ( SysTick->VAL + 1 ) * reload / board_systick_reload;   // both below 2^16
+    SysTick->LOAD = MAX( remain, 2 ) - 1;
+    SysTick->VAL = 0;
+    SysTick->LOAD = reload - 1;
+    board_systick_reload = reload;
+
+    /* the cycle count carries on from where it was at the old rate */
+    board_cycle_tick = board_tick;
+    board_cycle_base = cycles - ( reload - MAX( remain, 2 ) );
+
+#ifdef OS_USING_HAL_UART
+    hal_uart_clock_end();
+#endif
+    OS_EXIT_CRITICAL();
+
+    return OS_ERR_NONE;
+}
+
+#ifdef OS_TICKLESS_EN
+/**
+  * @brief  Sleeps until the kernel deadline or any interrupt, whichever comes
+  *         first. Called with interrupts disabled, a pending interrupt still
+  *         wakes the core and is taken once the kernel re-enables them.
+  *         SysTick is reloaded with the whole sleep period and the partial
+  *         tick left over on an early wakeup is carried into the next period.
+  * @param  tick: ticks until the nearest timer expires, UINT32_MAX if none
+  * @retval Number of ticks slept that were not counted by SysTick_Handler
+  */
+os_uint32_t os_board_sleep( os_uint32_t tick )
+{
+    os_uint32_t ctrl;
+    os_uint32_t remain;
+    os_uint32_t sleep_cycles;
+    os_uint32_t elapsed_cycles;
+    os_uint32_t elapsed;
+
+    tick = MIN( tick, (SysTick_LOAD_RELOAD_Msk + 1) / board_systick_reload );
+    if( tick <= 1 )
+    {
+        __WFI();
+        return 0;
+    }
+
+    /* stopping the counter also reads COUNTFLAG back to zero, a tick that
+       is already pending is still counted by SysTick_Handler */
+    ctrl = SysTick->CTRL;
+    SysTick->CTRL = ctrl & ~SysTick_CTRL_ENABLE_Msk;
+
+    /* cycles left in the current tick, then whole ticks up to the deadline */
+    remain = SysTick->VAL + 1;
+    sleep_cycles = remain + ( tick - 1 ) * board_systick_reload;
+    SysTick->LOAD = sleep_cycles - 1;
+    SysTick->VAL = 0;
+    SysTick->CTRL = ctrl;
+
+    __WFI();
+
+    ctrl = SysTick->CTRL;
+    SysTick->CTRL = ctrl & ~SysTick_CTRL_ENABLE_Msk;
+    if( ctrl & SysTick_CTRL_COUNTFLAG_Msk )
+    {
+        /* slept the whole period, SysTick_Handler counts the last tick */
+        elapsed = tick - 1;
+        elapsed_cycles = ( sleep_cycles - 1 ) - SysTick->VAL;
+        remain = ( elapsed_cycles < board_systick_reload ) ? ( board_systick_reload - elapsed_cycles ) : 1;
+    }
+    else
+    {
+        /* woken early by another interrupt */
+        elapsed_cycles = sleep_cycles - ( SysTick->VAL + 1 );
+        if( elapsed_cycles < remain )
+        {
+            elapsed = 0;
+            remain -= elapsed_cycles;
+        }
+        else
+        {
+            elapsed_cycles -= remain;
+            elapsed = 1 + elapsed_cycles / board_systick_reload;
+            remain = board_systick_reload - elapsed_cycles % board_systick_reload;
+        }
+    }
+
+    /* finish the partial tick, then fall back to the periodic reload */
+    SysTick->LOAD = MAX( remain, 2 ) - 1;
+    SysTick->VAL = 0;
+    SysTick->CTRL = ctrl;
+    SysTick->LOAD = board_systick_reload - 1;
+
+    board_tick += elapsed;
+    return elapsed;
+}
+#endif // (OS_TICKLESS_EN > 0)
+
 /* Private function implementations ------------------------------------------*/
 /**
   * @brief  System Clock Configuration
@@ -166,6 +412,80 @@ static void SystemClock_Config( void )
     LL_RCC_SetAPB2Prescaler( LL_RCC_APB2_DIV_1 );           // APB2 CLK 32MHz
 }
 
+/**
+  * @brief  Raises the core voltage and the flash wait states before speeding
+  *         up, and lowers them only once running at the slower clock.
+  * @param  p_from: clock point running now
+  * @param  p_to: clock point to run at
+  * @retval None
+  */
+static void board_clock_switch( const board_clock_t *p_from, const board_clock_t *p_to )
+{
+    /* VOS 1 has the lowest register value, then 2 and 3 */
+    if( p_to->scale < p_from->scale )
+    {
+        board_clock_scale( p_to->scale );
+    }
+    if( p_to->latency > p_from->latency )
+    {
+        LL_FLASH_SetLatency( p_to->latency );
+        while( LL_FLASH_GetLatency() != p_to->latency );
+    }
+
+    switch( p_to->source )
+    {
+        case LL_RCC_SYS_CLKSOURCE_PLL:
+        case LL_RCC_SYS_CLKSOURCE_HSI:
+            LL_RCC_HSI_Enable();
+            while( !LL_RCC_HSI_IsReady() );
+            if( p_to->source == LL_RCC_SYS_CLKSOURCE_PLL )
+            {
+                LL_RCC_PLL_Enable();
+                while( !LL_RCC_PLL_IsReady() );
+            }
+        break;
+
+        case LL_RCC_SYS_CLKSOURCE_MSI:
+            LL_RCC_MSI_Enable();
+            while( !LL_RCC_MSI_IsReady() );
+            LL_RCC_MSI_SetRange( p_to->msi_range );
+        break;
+    }
+    LL_RCC_SetSysClkSource( p_to->source );
+    while( LL_RCC_GetSysClkSource() != p_to->status );
+
+    if( p_to->latency < p_from->latency )
+    {
+        LL_FLASH_SetLatency( p_to->latency );
+    }
+    if( p_to->scale > p_from->scale )
+    {
+        board_clock_scale( p_to->scale );
+    }
+
+    /* stop the oscillators the new point does not run from */
+    if( p_to->source != LL_RCC_SYS_CLKSOURCE_PLL )
+    {
+        LL_RCC_PLL_Disable();
+    }
+    if( p_to->source == LL_RCC_SYS_CLKSOURCE_MSI )
+    {
+        LL_RCC_HSI_Disable();
+    }
+    else
+    {
+        LL_RCC_MSI_Disable();
+    }
+}
+
+static void board_clock_scale( os_uint32_t scale )
+{
+    LL_APB1_GRP1_EnableClock( LL_APB1_GRP1_PERIPH_PWR );
+    LL_PWR_SetRegulVoltageScaling( scale );
+    while( LL_PWR_IsActiveFlag_VOSF() );
+    LL_APB1_GRP1_DisableClock( LL_APB1_GRP1_PERIPH_PWR );
+}
+
 /* integrity check of type sizes */
 OS_ASSERT_SIZE(  os_int8_t, 1);
 OS_ASSERT_SIZE(os_uint8_t, 1);
@@ -26,6 +26,16 @@ extern "C" {
 /* Exported function prototypes -----------------------------------------------*/
 void os_board_init( void );
 void os_board_idle( void );
+#ifdef OS_TICKLESS_EN
+os_uint32_t os_board_sleep( os_uint32_t tick );
+#endif
+os_uint32_t os_board_cycles( void );
+os_uint32_t os_board_clock_hz( os_uint8_t point );
+os_uint8_t os_board_clock_get( void );
+os_err_t os_board_clock_set( os_uint8_t point );
+#ifdef OS_URGENT_EN
+void os_board_urgent_pend( void );
+#endif
 #ifdef OS_ASSERT_EN
 void os_assert_failed(char *file, os_uint32_t line);
 #endif
@@ -11,6 +11,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "stm32l0xx_ll_bus.h"
+#include "stm32l0xx_ll_rcc.h"
 #include "stm32l0xx_ll_gpio.h"
 #include "stm32l0xx_ll_usart.h"
 #include "hal_uart.h"
@@ -37,9 +38,6 @@
 #define TASK_EVT_UART0_TXD          0
 #define TASK_EVT_UART1_TXD          1
 
-#define CPU_APB1CLK                 (32000000uL)
-#define CPU_APB2CLK                 (32000000uL)
-
 /* Private typedef -----------------------------------------------------------*/
 typedef struct {
     os_uint8_t *rx_cache;
@@ -50,10 +48,12 @@ typedef struct {
 
 typedef struct {
     void (*callback)( os_uint8_t event );
+    os_uint32_t baud_rate;
     os_uint8_t rx_head;
     os_uint8_t rx_tail;
     os_uint8_t tx_head;
     os_uint8_t tx_tail;
+    os_uint8_t clock_stopped;               // stopped by hal_uart_clock_begin()
 } uart_ctrl_t;
 
 typedef struct {
@@ -84,10 +84,6 @@ static USART_TypeDef* const USARTx[HAL_UART_PORT_MAX] = {
     USART2
 };
 
-static os_uint32_t const PeriphClk[HAL_UART_PORT_MAX] = {
-    CPU_APB1CLK
-};
-
 static uart_event_t const uart_event[HAL_UART_PORT_MAX] = {
     {
         .rxd = TASK_EVT_UART0_RXD,
@@ -102,6 +98,7 @@ static uart_ctrl_t uart_ctrl[HAL_UART_PORT_MAX] = { 0 };
 
 /* Private function prototypes -----------------------------------------------*/
 static void hal_uart_isr( os_uint8_t port );
+static os_uint32_t hal_uart_periph_clk( os_uint8_t port );
 
 extern void USART2_IRQHandler( void );
 
@@ -201,7 +198,7 @@ void hal_uart_open( os_uint8_t port, const hal_uart_config_t *cfg )
 
     // set baud rate
     LL_USART_SetBaudRate( USARTx[port],
-                          PeriphClk[port],
+                          hal_uart_periph_clk( port ),
                           LL_USART_OVERSAMPLING_16, 
                           cfg->baud_rate );
 
@@ -269,6 +266,7 @@ void hal_uart_open( os_uint8_t port, const hal_uart_config_t *cfg )
     // init uart control body info
     os_memset( &uart_ctrl[port], 0, sizeof(uart_ctrl_t) );
     uart_ctrl[port].callback = cfg->callback;
+    uart_ctrl[port].baud_rate = cfg->baud_rate;
     
     LL_USART_EnableDirectionRx( USARTx[port] );
     LL_USART_EnableDirectionTx( USARTx[port] );
@@ -384,7 +382,97 @@ void hal_uart_close( os_uint8_t port )
     }
 }
 
+/**
+  * @brief  Waits until the open ports have sent all they hold, the last byte
+  *         included, so hal_uart_clock_begin() finds them done.
+  * @param  None
+  * @note   Called with interrupts enabled, the TXE interrupt empties the cache
+  * @retval None
+  */
+void hal_uart_clock_drain( void )
+{
+    os_uint8_t port;
+
+    for( port = 0; port < HAL_UART_PORT_MAX; port++ )
+    {
+        if( LL_USART_IsEnabled(USARTx[port]) )
+        {
+            while( !RING_BUF_EMPTY(uart_ctrl[port].tx_head, uart_ctrl[port].tx_tail) ||
+                   !LL_USART_IsActiveFlag_TC(USARTx[port]) );
+        }
+    }
+}
+
+/**
+  * @brief  Stops the open ports before the board changes the core clock.
+  *         Leaves them all running if any is still sending, receiving a
+  *         byte or holding one not yet read, the switch has to wait then.
+  * @param  None
+  * @note   Called with interrupts disabled, followed by hal_uart_clock_end()
+  *         when it returns TRUE
+  * @retval TRUE if the ports are stopped, FALSE if one is busy
+  */
+os_uint8_t hal_uart_clock_begin( void )
+{
+    os_uint8_t port;
+
+    for( port = 0; port < HAL_UART_PORT_MAX; port++ )
+    {
+        if( LL_USART_IsEnabled(USARTx[port]) &&
+            ( !LL_USART_IsActiveFlag_TC(USARTx[port]) ||
+              LL_USART_IsActiveFlag_BUSY(USARTx[port]) ||
+              LL_USART_IsActiveFlag_RXNE(USARTx[port]) ) )
+        {
+            return FALSE;
+        }
+    }
+
+    for( port = 0; port < HAL_UART_PORT_MAX; port++ )
+    {
+        if( LL_USART_IsEnabled(USARTx[port]) )
+        {
+            LL_USART_Disable( USARTx[port] );
+            uart_ctrl[port].clock_stopped = TRUE;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+  * @brief  Derives the baud rate registers from the new clock and restarts
+  *         the ports stopped by hal_uart_clock_begin().
+  * @param  None
+  * @note   SystemCoreClock has to hold the new core clock
+  * @retval None
+  */
+void hal_uart_clock_end( void )
+{
+    os_uint8_t port;
+
+    for( port = 0; port < HAL_UART_PORT_MAX; port++ )
+    {
+        if( uart_ctrl[port].clock_stopped )
+        {
+            uart_ctrl[port].clock_stopped = FALSE;
+            LL_USART_SetBaudRate( USARTx[port],
+                                  hal_uart_periph_clk( port ),
+                                  LL_USART_OVERSAMPLING_16,
+                                  uart_ctrl[port].baud_rate );
+            LL_USART_Enable( USARTx[port] );
+        }
+    }
+}
+
 /* Private function implementations ------------------------------------------*/
+/* all ports sit on APB1, which follows the clock point set by the board */
+static os_uint32_t hal_uart_periph_clk( os_uint8_t port )
+{
+    (void)port;
+
+    return __LL_RCC_CALC_PCLK1_FREQ( SystemCoreClock, LL_RCC_GetAPB1Prescaler() );
+}
+
 /**
   * @brief  Function brief
   * @param  param1
@@ -90,6 +90,9 @@ os_uint8_t hal_uart_getc( os_uint8_t port );
 os_uint8_t hal_uart_tx_buf_free( os_uint8_t port );
 os_uint8_t hal_uart_rx_buf_used( os_uint8_t port );
 void hal_uart_close( os_uint8_t port );
+void hal_uart_clock_drain( void );
+os_uint8_t hal_uart_clock_begin( void );
+void hal_uart_clock_end( void );
 
 #ifdef __cplusplus
 }
@@ -14,23 +14,29 @@
 #include "hal_drivers.h"
 #include "components/cli/cli.h"
 #include "components/led/led.h"
+#include "components/governor/governor.h"
+#include "components/bus/bus.h"
 #include "application/demo.h"
 
 /* Tasks ---------------------------------------------------------------------*/
+/* fields not given default to zero, see OS_TASK_t for what each one means */
 static const OS_TASK_t os_task_array[] = {
 #ifdef OS_USING_HAL_UART
-    { hal_uart_rxd_init, hal_uart_rxd_task },
+    { .p_task_init = hal_uart_rxd_init, .p_task_handler = hal_uart_rxd_task },
 #endif
 #ifdef OS_USING_HAL_UART
-    { hal_uart_txd_init, hal_uart_txd_task },
+    { .p_task_init = hal_uart_txd_init, .p_task_handler = hal_uart_txd_task },
 #endif
 #ifdef OS_USING_CLI
-    { cli_init, cli_task },
+    { .p_task_init = cli_init, .p_task_handler = cli_task },
 #endif
 #ifdef OS_USING_LED
-    { led_init, led_task },
+    { .p_task_init = led_init, .p_task_handler = led_task },
 #endif
-    { demo_init, demo_task },
+#ifdef OS_USING_GOVERNOR
+    { .p_task_init = governor_init, .p_task_handler = governor_task },
+#endif
+    { .p_task_init = demo_init, .p_task_handler = demo_task },
 };
 
 /* Do NOT modify -------------------------------------------------------------*/
@@ -39,6 +45,15 @@ static OS_TCB_t os_tcb_array [OS_TASK_NUM] = {0};
 const OS_TASK_t *os_task_list = os_task_array;
 const os_uint8_t os_task_max = OS_TASK_NUM;
 OS_TCB_t *os_task_tcb = os_tcb_array;
+typedef char os_task_num_check_t[(OS_TASK_NUM <= OS_TASK_MAX) ? 1 : -1];
+
+/* Bus topics ----------------------------------------------------------------*/
+#ifdef OS_USING_BUS
+/* subscribers fixed at build time, e.g. [TOPIC_KEY] = { BUS_TASK(3) | BUS_TASK(5) } */
+const os_uint32_t bus_topic_table[BUS_TOPIC_MAX][BUS_MAP_WORDS] = {
+    {0},
+};
+#endif
 
 /****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
 
@@ -16,13 +16,59 @@
  ******************************************************************************/
 #define OS_ASSERT_EN
 #define OS_MSG_EN
+#define OS_MSG_PRIO_MAX       2             // message levels per task, up to 8, each one a queue in the TCB
+#define OS_MSG_DEPTH          16            // messages a task may have queued unless OS_TASK_t.msg_depth says
+#define OS_MSG_BATCH          8             // messages handed to a task per scheduler pass unless OS_TASK_t.msg_batch says
 #define OS_CLOCK_EN
+#define OS_TICKLESS_EN                      // requires OS_CLOCK_EN
 #define OS_TIMER_EN
 #define OS_TIMER_USE_HEAP
 #define OS_TIMER_MAX          8             // meaningless if defined OS_TIMER_USE_HEAP 
 #define OS_MEM_EN
-
+#define OS_MSG_POOL_EN                      // fixed-block pools for os_msg_create(), the heap serves larger ones
+#define OS_MSG_POOL_8         8             // blocks per size class, payload bytes
+#define OS_MSG_POOL_16        4
+#define OS_MSG_POOL_32        2
+#define OS_MSG_POOL_64        0
+#define OS_MSG_POOL_128       0
+#define OS_MSG_MULTICAST_EN                 // os_msg_send_multi(), one buffer queued for several tasks
+#define OS_MSG_REF_MAX        8             // multicast deliveries queued at once
+//#define OS_MBOX_EN                        // static mailboxes, OS_MBOX_DEFINE() in os_config.c
+#define OS_DEFER_EN
+#define OS_DEFER_PRIO_MAX     4             // one queue per NVIC priority level
+#define OS_DEFER_QUEUE_SIZE   8             // should be a power of 2
+#define OS_IDLE_EN                          // os_idle_work_submit(), run in slices when no task is ready
+#define OS_IDLE_WORK_MAX      4             // work items queued at once, up to 32
+//#define OS_RPC_EN                         // os_rpc_call(), requires OS_MSG_EN, OS_POST_EN and OS_CLOCK_EN
+#define OS_RPC_MAX            4             // calls awaiting their reply at a time
+
+//#define OS_CRITICAL_STATS_EN              // longest critical section, requires OS_CYCLE_COUNTER()
 #define OS_TASK_EVENT_MAX     32            // should be 8, 16 or 32
+//#define OS_EVENT_MASK_EN                  // allow OS_TASK_t.p_task_handler_mask
+#define OS_POST_EN                          // os_task_post_event(), slots given per task in os_config.c
+//#define OS_EVENT_COUNT_EN                 // count repeated events per task, see OS_EVENT_COUNTED()
+#define OS_CO_EN                            // coroutine tasks, requires OS_TIMER_EN and OS_MSG_EN
+//#define OS_URGENT_EN                      // preemptive level for tasks with OS_TASK_t.urgent set
+#define OS_URGENT_PRIO        3             // NVIC priority of the urgent level, lowest on Cortex-M0+
+#define OS_TASK_MAX           32            // should not be larger than 256
+#define OS_SCHED_POLICY       OS_SCHED_POLICY_PRIO  // or OS_SCHED_POLICY_RR, OS_SCHED_POLICY_WFQ
+//#define OS_SCHED_STATS_EN                 // per task max ready-to-dispatch wait, requires OS_CLOCK_EN
+
+#define OS_BUDGET_EN                        // per task handler time budget, requires OS_CLOCK_EN
+#define OS_BUDGET_LOG_SIZE    8             // overruns kept, oldest dropped first
+//#define OS_BUDGET_HOOK(task_id, event_id, tick)   // called from SysTick on an overrun
+
+#define OS_LOAD_EN                          // os_cpu_load() and the CLI "load" command, requires OS_CLOCK_EN
+#define OS_LOAD_PERIOD        1000          // ticks per sample, 1 s
+#define OS_LOAD_HIST_MAX      60            // samples kept, 1 minute
+
+#define OS_TRACE_EN                         // scheduler trace ring, dumped by the CLI "trace" command
+#define OS_TRACE_SIZE         128           // 8-byte records, should be a power of 2
+
+//#define OS_PROFILE_EN                     // handler execution time per (task, event)
+#define OS_PROFILE_SLOT_MAX   16            // should be a power of 2
+#define OS_PROFILE_HIST_MAX   16            // log2 histogram bins
+#define OS_PROFILE_HIST_SHIFT 6             // first bin holds < 128 cycles
 /*******************************************************************************
  * PEOS HAL Drivers
  ******************************************************************************/
@@ -54,6 +100,25 @@
 #define LED_BLINK_EN            1
 #endif
 
+/*******************************************************************************
+ * PEOS Components - Governor
+ ******************************************************************************/
+//#define OS_USING_GOVERNOR                 // clock point from the CPU load, requires OS_LOAD_EN and OS_TIMER_EN
+#ifdef  OS_USING_GOVERNOR
+#define GOVERNOR_UP             800         // permille, jump to the fastest clock point
+#define GOVERNOR_TARGET         600         // permille, step down while the slower point stays below
+#define GOVERNOR_HOLD           3           // load periods before a step down
+#define GOVERNOR_BACKLOG_UP     4           // ready tasks that force the fastest point, 0 to ignore
+#endif
+
+/*******************************************************************************
+ * PEOS Components - Topic bus
+ ******************************************************************************/
+//#define OS_USING_BUS                      // publish/subscribe, requires OS_MSG_MULTICAST_EN
+#ifdef  OS_USING_BUS
+#define BUS_TOPIC_MAX           8           // topic ids 0 .. BUS_TOPIC_MAX-1, named by the application
+#endif
+
 /*******************************************************************************
  * PEOS Components - FIFO buffer
  ******************************************************************************/
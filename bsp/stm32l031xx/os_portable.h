@@ -33,6 +33,7 @@ extern "C" {
 typedef uint8_t     os_uint8_t;
 typedef uint16_t    os_uint16_t;
 typedef uint32_t    os_uint32_t;
+typedef uint64_t    os_uint64_t;
 typedef int8_t      os_int8_t;
 typedef int16_t     os_int16_t;
 typedef int32_t     os_int32_t;
@@ -41,15 +42,27 @@ typedef double      os_fpt64_t;
 typedef size_t      os_size_t;
 
 /* Exported macro -------------------------------------------------------------*/
-#define OS_ENTER_CRITICAL()         __disable_interrupt()
-#define OS_EXIT_CRITICAL()          __enable_interrupt()
+#define OS_INT_SAVE()               os_port_int_save()  // no BASEPRI on Cortex-M0+, PRIMASK only
+#define OS_INT_RESTORE(state)       __set_PRIMASK(state)
+#define OS_MEMORY_BARRIER()         __DMB()
+#define OS_CYCLE_COUNTER()          os_board_cycles()   // no DWT on Cortex-M0+
+#define OS_URGENT_PEND()            os_board_urgent_pend()
+#define OS_IN_ISR()                 (__get_IPSR() != 0)
 #define os_memset(ptr, val, len)    memset(ptr, val, len)
+#define os_memcpy(dst, src, len)    memcpy(dst, src, len)
 #define os_strcmp(s1, s2)           strcmp(s1, s2)
 #define os_strlen(s)                strlen(s)
 
 /* Exported variables ---------------------------------------------------------*/
 
 /* Exported function prototypes -----------------------------------------------*/
+__STATIC_INLINE os_uint32_t os_port_int_save( void )
+{
+    os_uint32_t state = __get_PRIMASK();
+    __disable_interrupt();
+    return state;
+}
+
 #ifdef __cplusplus
 }
 #endif
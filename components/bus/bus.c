@@ -0,0 +1,125 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/*
+ * Publish/subscribe on top of os_msg. Topic ids run from 0 to BUS_TOPIC_MAX-1
+ * and are named by the application. The subscribers of a topic are its row
+ * of bus_topic_table[] in flash, plus the tasks that bus_subscribe() from
+ * their init, kept in a bitmap in RAM. A publish walks the set bits of both
+ * only and queues the one buffer for all of them with os_msg_send_multi().
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "components/bus/bus.h"
+
+#ifdef OS_USING_BUS
+#ifndef OS_MSG_MULTICAST_EN
+#error "OS_USING_BUS requires OS_MSG_MULTICAST_EN."
+#endif
+#if BUS_TOPIC_MAX > 128
+#error "BUS_TOPIC_MAX should not be larger than 128, topics travel as the message type."
+#endif
+
+/* Exported variables --------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* Private typedef -----------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+extern const os_uint8_t os_task_max;
+
+static os_uint32_t bus_map[BUS_TOPIC_MAX][BUS_MAP_WORDS];
+
+/* Private function prototypes -----------------------------------------------*/
+/* Exported function implementations -----------------------------------------*/
+os_err_t bus_subscribe( os_uint8_t topic, os_uint8_t task_id )
+{
+    if( topic >= BUS_TOPIC_MAX || task_id >= os_task_max )
+    {
+        return OS_ERR_INVAL;
+    }
+
+    OS_ATOMIC_FETCH_OR( &bus_map[topic][task_id >> 5], BUS_TASK( task_id ) );
+    return OS_ERR_NONE;
+}
+
+/* a subscriber from bus_topic_table[] stays, OS_ERR_INVAL */
+os_err_t bus_unsubscribe( os_uint8_t topic, os_uint8_t task_id )
+{
+    if( topic >= BUS_TOPIC_MAX || task_id >= os_task_max ||
+        ( bus_topic_table[topic][task_id >> 5] & BUS_TASK( task_id ) ) )
+    {
+        return OS_ERR_INVAL;
+    }
+
+    OS_ATOMIC_FETCH_AND( &bus_map[topic][task_id >> 5], ~BUS_TASK( task_id ) );
+    return OS_ERR_NONE;
+}
+
+/*
+ * Hands pmsg to every subscriber of the topic, lower task ids first, so the
+ * queues fill in task priority order. The bus takes the message in any case:
+ * it is deleted when nobody subscribes, returning OS_ERR_EMPTY, or when too
+ * few multicast nodes are left, returning OS_ERR_FULL. Safe from interrupts.
+ */
+os_err_t bus_publish( os_uint8_t topic, void *pmsg )
+{
+    os_uint8_t task_id[OS_TASK_MAX];
+    os_uint8_t count = 0;
+    os_uint32_t map;
+    os_uint8_t i;
+    os_err_t err;
+
+    OS_ASSERT( pmsg != NULL );
+    OS_ASSERT( topic < BUS_TOPIC_MAX );
+
+    for( i = 0; i < BUS_MAP_WORDS; i++ )
+    {
+        for( map = bus_topic_table[topic][i] | bus_map[topic][i]; map; map &= map - 1 )
+        {
+            task_id[count++] = (os_uint8_t)( ( i << 5 ) + OS_CTZ32( map ) );
+        }
+    }
+
+    if( count == 0 )
+    {
+        os_msg_delete( pmsg );
+        return OS_ERR_EMPTY;
+    }
+
+    err = os_msg_send_multi( pmsg, task_id, count );
+    if( err != OS_ERR_NONE )
+    {
+        os_msg_delete( pmsg );
+    }
+    return err;
+}
+
+os_uint8_t bus_subscribers( os_uint8_t topic )
+{
+    os_uint32_t map;
+    os_uint8_t count = 0;
+    os_uint8_t i;
+
+    OS_ASSERT( topic < BUS_TOPIC_MAX );
+
+    for( i = 0; i < BUS_MAP_WORDS; i++ )
+    {
+        for( map = bus_topic_table[topic][i] | bus_map[topic][i]; map; map &= map - 1 )
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+#endif /* OS_USING_BUS */
+
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
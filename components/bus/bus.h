@@ -0,0 +1,50 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ * 
+ ******************************************************************************/
+
+#ifndef __BUS_H__
+#define __BUS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes -------------------------------------------------------------------*/
+#include "os.h"
+
+#ifdef OS_USING_BUS
+/* Exported define ------------------------------------------------------------*/
+#define BUS_MAP_WORDS           ( ( OS_TASK_MAX + 31 ) / 32 )
+
+/* Exported typedef -----------------------------------------------------------*/
+/* Exported macro -------------------------------------------------------------*/
+/* bit of a task in word task_id / 32 of a bus_topic_table[] row */
+#define BUS_TASK(task_id)               ( (os_uint32_t)1 << ( (task_id) & 0x1F ) )
+
+/* a message for the topic, os_msg_type() of it gives the topic back */
+#define bus_msg_create(topic, len)      os_msg_create( (len), (os_int8_t)(topic) )
+
+/* Exported variables ---------------------------------------------------------*/
+/* subscribers fixed at build time, one row per topic, defined in os_config.c */
+extern const os_uint32_t bus_topic_table[BUS_TOPIC_MAX][BUS_MAP_WORDS];
+
+/* Exported function prototypes -----------------------------------------------*/
+os_err_t bus_subscribe( os_uint8_t topic, os_uint8_t task_id );
+os_err_t bus_unsubscribe( os_uint8_t topic, os_uint8_t task_id );
+os_err_t bus_publish( os_uint8_t topic, void *pmsg );
+os_uint8_t bus_subscribers( os_uint8_t topic );
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__BUS_H__
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
@@ -23,6 +23,7 @@
 /* Exported variables --------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
 #define CLI_MAX_KEY_LEN             7
+#define CLI_MAX_ARGS                8
 
 #define ASCII_LF                    0x0A
 #define ASCII_CR                    0x0D
@@ -52,11 +53,46 @@ static void *p_cli_tx_fifo;
 #endif
 
 static os_uint8_t cli_task_id;
+static const cli_cmd_mapping_t *p_cli_user_cmds;
 
 /* Private function prototypes -----------------------------------------------*/
 static void cli_uart_driver_callback( os_uint8_t event );
 static void cli_rx_key( const cli_key_t *p_key );
 static void cli_process_cmd( char *p_cmd );
+static const cli_cmd_mapping_t *cli_find_cmd( const cli_cmd_mapping_t *p_cmds, const char *str );
+static void cli_print_uint_w( os_uint32_t num, os_uint8_t width );
+#ifdef OS_PROFILE_EN
+static void cli_cmd_top( os_uint8_t argc, char **argv );
+#endif
+#ifdef OS_LOAD_EN
+static void cli_cmd_load( os_uint8_t argc, char **argv );
+#endif
+#ifdef OS_MSG_POOL_EN
+static void cli_cmd_pool( os_uint8_t argc, char **argv );
+#endif
+static void cli_cmd_msgq( os_uint8_t argc, char **argv );
+#ifdef OS_TRACE_EN
+static void cli_cmd_trace( os_uint8_t argc, char **argv );
+static void cli_print_le( os_uint32_t num, os_uint8_t len );
+#endif
+
+/* Kernel commands, terminated by { NULL, NULL } -----------------------------*/
+static const cli_cmd_mapping_t cli_kernel_cmds[] = {
+#ifdef OS_PROFILE_EN
+    { "top", cli_cmd_top },
+#endif
+#ifdef OS_LOAD_EN
+    { "load", cli_cmd_load },
+#endif
+#ifdef OS_MSG_POOL_EN
+    { "pool", cli_cmd_pool },
+#endif
+    { "msgq", cli_cmd_msgq },
+#ifdef OS_TRACE_EN
+    { "trace", cli_cmd_trace },
+#endif
+    { NULL, NULL },
+};
 
 /* Exported function implementations -----------------------------------------*/
 void cli_init( os_uint8_t task_id )
@@ -67,6 +103,7 @@ void cli_init( os_uint8_t task_id )
 
     p_cli_key = NULL;
     p_cli_cmd = NULL;
+    p_cli_user_cmds = NULL;
 
 #if CLI_TX_BUF_SIZE > 0
     p_cli_tx_fifo = NULL;
@@ -85,15 +122,18 @@ void cli_init( os_uint8_t task_id )
 
 void cli_task( os_int8_t event_id )
 {
+    OS_MSG_LIST_t keys;
     cli_key_t *p_key;
 
     OS_ASSERT( event_id ==  OS_TASK_EVT_MSG );
 
-    p_key = (cli_key_t *)os_msg_recv( os_get_task_id_self() );
-
-    OS_ASSERT( p_key != NULL );
-    cli_rx_key( p_key );
-    os_msg_delete( p_key );
+    /* a paste arrives as a burst of key messages, take them in one call */
+    os_msg_recv_all( os_get_task_id_self(), &keys );
+    while( (p_key = (cli_key_t *)os_msg_list_pop( &keys )) != NULL )
+    {
+        cli_rx_key( p_key );
+        os_msg_delete( p_key );
+    }
 }
 
 /*
@@ -134,9 +174,10 @@ void cli_disable( void )
 }
 */
 
+/* cmd is a table terminated by { NULL, NULL }, searched after the kernel commands */
 void cli_register_cmds( const cli_cmd_mapping_t *cmd )
 {
-    
+    p_cli_user_cmds = cmd;
 }
 
 void cli_print_char( char ch )
@@ -289,7 +330,10 @@ static void cli_uart_driver_callback( os_uint8_t event )
                         p_cli_key->val[p_cli_key->len++] = byte;
                         if(p_cli_key->len == CLI_MAX_KEY_LEN)
                         {
-                            os_msg_send( p_cli_key, cli_task_id );
+                            if( os_msg_send( p_cli_key, cli_task_id ) != OS_ERR_NONE )
+                            {
+                                os_msg_delete( p_cli_key );  // the CLI is behind, drop the keys
+                            }
                             p_cli_key = NULL;
                         }
                     }
@@ -331,7 +375,10 @@ static void cli_uart_driver_callback( os_uint8_t event )
         case HAL_UART_EVENT_IDLE:
             if( p_cli_key )
             {
-                os_msg_send( p_cli_key, cli_task_id );
+                if( os_msg_send( p_cli_key, cli_task_id ) != OS_ERR_NONE )
+                {
+                    os_msg_delete( p_cli_key );
+                }
                 p_cli_key = NULL;
             }
         break;
@@ -419,9 +466,325 @@ static void cli_rx_key( const cli_key_t *p_key )
 
 static void cli_process_cmd( char *p_cmd )
 {
-    cli_print_str( "CMD:" );
-    cli_print_str( p_cmd );
-    cli_print_str( "\r\n" );
+    char *argv[CLI_MAX_ARGS];
+    os_uint8_t argc = 0;
+    const cli_cmd_mapping_t *p_map;
+
+    while( *p_cmd && argc < CLI_MAX_ARGS )
+    {
+        while( *p_cmd == ' ' )
+        {
+            *p_cmd++ = '\0';
+        }
+
+        if( *p_cmd )
+        {
+            argv[argc++] = p_cmd;
+            while( *p_cmd && *p_cmd != ' ' )
+            {
+                p_cmd++;
+            }
+        }
+    }
+
+    if( argc == 0 )
+        return;
+
+    p_map = cli_find_cmd( cli_kernel_cmds, argv[0] );
+    if( p_map == NULL && p_cli_user_cmds != NULL )
+    {
+        p_map = cli_find_cmd( p_cli_user_cmds, argv[0] );
+    }
+
+    if( p_map )
+    {
+        p_map->handler( argc, argv );
+    }
+    else
+    {
+        cli_print_str( "Unknown command: " );
+        cli_print_str( argv[0] );
+        cli_print_str( "\r\n" );
+    }
+}
+
+static const cli_cmd_mapping_t *cli_find_cmd( const cli_cmd_mapping_t *p_cmds, const char *str )
+{
+    for( ; p_cmds->string != NULL; p_cmds++ )
+    {
+        if( os_strcmp( p_cmds->string, str ) == 0 )
+        {
+            return p_cmds;
+        }
+    }
+
+    return NULL;
+}
+
+/* right aligned in a field of width characters */
+static void cli_print_uint_w( os_uint32_t num, os_uint8_t width )
+{
+    char str[UINT_STR_LEN_MAX];
+    os_uint8_t len;
+    os_uint8_t i;
+
+    len = tostr_uint( num, str );
+    while( width > len )
+    {
+        cli_print_char( ' ' );
+        width--;
+    }
+
+    for( i = 0; i < len; i++ )
+    {
+        cli_print_char( str[i] );
+    }
+}
+
+#ifdef OS_PROFILE_EN
+/*
+ * top        - handler time per (task, event), busiest first
+ * top hist   - same with the log2 histogram of each row
+ * top reset  - clear all counters
+ */
+static void cli_cmd_top( os_uint8_t argc, char **argv )
+{
+    OS_PROFILE_t profile;
+    os_uint8_t printed[(OS_PROFILE_SLOT_MAX + 7) / 8];
+    os_uint8_t hist = FALSE;
+    os_uint8_t index;
+    os_uint8_t busiest;
+    os_uint8_t bin;
+    os_uint64_t busiest_sum;
+    os_uint64_t total = 0;
+
+    if( argc > 1 )
+    {
+        if( os_strcmp( argv[1], "reset" ) == 0 )
+        {
+            os_profile_reset();
+            cli_print_str( "OK\r\n" );
+            return;
+        }
+        hist = ( os_strcmp( argv[1], "hist" ) == 0 );
+    }
+
+    for( index = 0; index < OS_PROFILE_SLOT_MAX; index++ )
+    {
+        if( os_profile_get( index, &profile ) == OS_ERR_NONE )
+        {
+            total += profile.sum;
+        }
+    }
+
+    cli_print_str( "TASK  EVT     COUNT       MIN       AVG       MAX  CPU%\r\n" );
+    os_memset( printed, 0, sizeof(printed) );
+    for( ;; )
+    {
+        busiest = OS_PROFILE_SLOT_MAX;
+        busiest_sum = 0;
+        for( index = 0; index < OS_PROFILE_SLOT_MAX; index++ )
+        {
+            if( (printed[index >> 3] & BV(index & 0x07)) == 0 &&
+                os_profile_get( index, &profile ) == OS_ERR_NONE &&
+                ( busiest == OS_PROFILE_SLOT_MAX || profile.sum > busiest_sum ) )
+            {
+                busiest = index;
+                busiest_sum = profile.sum;
+            }
+        }
+
+        if( busiest == OS_PROFILE_SLOT_MAX )
+            break;
+
+        printed[busiest >> 3] |= BV(busiest & 0x07);
+        os_profile_get( busiest, &profile );
+
+        cli_print_uint_w( profile.task_id, 4 );
+        if( profile.event_id == OS_TASK_EVT_MSG )
+        {
+            cli_print_str( "  MSG" );
+        }
+#ifdef OS_MBOX_EN
+        else if( profile.event_id == OS_TASK_EVT_MBOX )
+        {
+            cli_print_str( " MBOX" );
+        }
+#endif
+        else
+        {
+            cli_print_uint_w( (os_uint32_t)profile.event_id, 5 );
+        }
+        cli_print_uint_w( profile.count, 10 );
+        cli_print_uint_w( profile.min, 10 );
+        cli_print_uint_w( (os_uint32_t)( profile.sum / profile.count ), 10 );
+        cli_print_uint_w( profile.max, 10 );
+        cli_print_uint_w( (os_uint32_t)( ( total >= 100 ) ? profile.sum / ( total / 100 ) : ( total ? profile.sum * 100 / total : 0 ) ), 6 );
+        cli_print_str( "\r\n" );
+
+        if( hist )
+        {
+            cli_print_str( "         " );
+            for( bin = 0; bin < OS_PROFILE_HIST_MAX; bin++ )
+            {
+                cli_print_char( ' ' );
+                cli_print_uint( profile.hist[bin] );
+            }
+            cli_print_str( "\r\n" );
+        }
+    }
+
+    if( os_profile_missed_get() )
+    {
+        cli_print_str( "missed: " );
+        cli_print_uint( os_profile_missed_get() );
+        cli_print_str( "\r\n" );
+    }
+}
+#endif //OS_PROFILE_EN
+
+#ifdef OS_LOAD_EN
+/*
+ * load       - busy share over the last 1, 10 and 60 load periods,
+ *              seconds with the default OS_LOAD_PERIOD
+ * load hist  - every sample kept in permille, oldest first, one per line
+ *              as tools/governor_replay.c reads them
+ */
+static void cli_cmd_load( os_uint8_t argc, char **argv )
+{
+    static const os_uint8_t windows[] = { 1, 10, 60 };
+    os_uint16_t permille;
+    os_uint8_t i;
+
+    if( argc > 1 && os_strcmp( argv[1], "hist" ) == 0 )
+    {
+        for( i = 0; os_cpu_load_get( i, &permille ) == OS_ERR_NONE; i++ )
+        {
+            cli_print_uint( permille );
+            cli_print_str( "\r\n" );
+        }
+        return;
+    }
+
+    for( i = 0; i < sizeof(windows) && windows[i] <= OS_LOAD_HIST_MAX; i++ )
+    {
+        permille = os_cpu_load( windows[i] );
+        cli_print_uint_w( windows[i], 3 );
+        cli_print_str( "s " );
+        cli_print_uint_w( permille / 10, 3 );
+        cli_print_char( '.' );
+        cli_print_uint( permille % 10 );
+        cli_print_str( "%\r\n" );
+    }
+}
+#endif //OS_LOAD_EN
+
+#ifdef OS_MSG_POOL_EN
+/*
+ * pool       - message pool per size class: blocks in use, high-water mark
+ *              and requests that found the pool empty
+ */
+static void cli_cmd_pool( os_uint8_t argc, char **argv )
+{
+    OS_MSG_POOL_t pool;
+    os_uint8_t index;
+
+    cli_print_str( "SIZE COUNT  USED   MAX  MISS\r\n" );
+    for( index = 0; os_msg_pool_get( index, &pool ) == OS_ERR_NONE; index++ )
+    {
+        cli_print_uint_w( pool.size, 4 );
+        cli_print_uint_w( pool.count, 6 );
+        cli_print_uint_w( pool.used, 6 );
+        cli_print_uint_w( pool.used_max, 6 );
+        cli_print_uint_w( pool.miss, 6 );
+        cli_print_str( "\r\n" );
+    }
+}
+#endif //OS_MSG_POOL_EN
+
+/*
+ * msgq       - message queue per task: depth limit, messages queued now,
+ *              high-water mark and sends refused as full
+ */
+static void cli_cmd_msgq( os_uint8_t argc, char **argv )
+{
+    OS_MSG_STAT_t stat;
+    os_uint8_t task_id;
+
+    cli_print_str( "TASK DEPTH COUNT   MAX  DROP\r\n" );
+    for( task_id = 0; os_msg_stat_get( task_id, &stat ) == OS_ERR_NONE; task_id++ )
+    {
+        cli_print_uint_w( task_id, 4 );
+        cli_print_uint_w( stat.depth, 6 );
+        cli_print_uint_w( stat.count, 6 );
+        cli_print_uint_w( stat.count_max, 6 );
+        cli_print_uint_w( stat.drop, 6 );
+        cli_print_str( "\r\n" );
+    }
+}
+
+#ifdef OS_TRACE_EN
+/*
+ * trace          - dump the trace ring as binary, decode with tools/trace2json.py
+ * trace on|off   - start or stop recording
+ * trace clear    - drop all records
+ *
+ * The dump is "PEOT", version, record size, record count (2 bytes) and
+ * OS_TRACE_TIME_HZ (4 bytes), then the records oldest first, multi-byte
+ * fields little-endian. Recording pauses while it is sent.
+ */
+static void cli_cmd_trace( os_uint8_t argc, char **argv )
+{
+    OS_TRACE_REC_t rec;
+    os_uint16_t count;
+    os_uint16_t index;
+    os_uint8_t on;
+
+    if( argc > 1 )
+    {
+        if( os_strcmp( argv[1], "on" ) == 0 )
+            os_trace_enable( TRUE );
+        else if( os_strcmp( argv[1], "off" ) == 0 )
+            os_trace_enable( FALSE );
+        else if( os_strcmp( argv[1], "clear" ) == 0 )
+            os_trace_clear();
+        else
+        {
+            cli_print_str( "Usage: trace [on|off|clear]\r\n" );
+            return;
+        }
+        cli_print_str( "OK\r\n" );
+        return;
+    }
+
+    on = os_trace_enable( FALSE );
+    count = os_trace_count();
+
+    cli_print_str( "PEOT" );
+    cli_print_char( 1 );
+    cli_print_char( (char)sizeof(OS_TRACE_REC_t) );
+    cli_print_le( count, 2 );
+    cli_print_le( OS_TRACE_TIME_HZ, 4 );
+    for( index = 0; index < count; index++ )
+    {
+        os_trace_get( index, &rec );
+        cli_print_le( rec.time, 4 );
+        cli_print_char( (char)rec.type );
+        cli_print_char( (char)rec.task_id );
+        cli_print_le( rec.arg, 2 );
+    }
+
+    os_trace_enable( on );
+}
+
+static void cli_print_le( os_uint32_t num, os_uint8_t len )
+{
+    while( len-- )
+    {
+        cli_print_char( (char)( num & 0xFF ) );
+        num >>= 8;
+    }
 }
+#endif //OS_TRACE_EN
 
 /****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
@@ -0,0 +1,120 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/* Includes ------------------------------------------------------------------*/
+#include "components/governor/governor.h"
+
+/* Exported variables --------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define GOVERNOR_EVT_SAMPLE                     0
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+#ifdef OS_USING_GOVERNOR
+#if !defined(OS_LOAD_EN) || !defined(OS_TIMER_EN)
+#error "OS_USING_GOVERNOR requires OS_LOAD_EN and OS_TIMER_EN."
+#endif
+
+static os_uint8_t governor_task_id;
+static governor_state_t governor_state;
+static os_uint32_t governor_hz[GOVERNOR_POINT_MAX];
+static os_uint8_t governor_points;
+
+static const governor_config_t governor_cfg = {
+    .up = GOVERNOR_UP,
+    .target = GOVERNOR_TARGET,
+    .hold = GOVERNOR_HOLD,
+    .backlog_up = GOVERNOR_BACKLOG_UP,
+};
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+/* Exported function implementations -----------------------------------------*/
+/*
+ * Picks the clock point for the next period from the load of the last one,
+ * measured at the point running now. Jumps to the fastest point under
+ * pressure and steps down one point at a time once the load scaled to the
+ * slower clock has stayed below target for hold periods. Keeps no state of
+ * its own, p_state carries it from one call to the next.
+ */
+os_uint8_t governor_decide( const governor_config_t *p_cfg, governor_state_t *p_state,
+                            const os_uint32_t *p_hz, os_uint8_t points,
+                            os_uint16_t load, os_uint8_t backlog )
+{
+    os_uint32_t projected;
+    os_uint8_t point = p_state->point;
+
+    if( load >= p_cfg->up || ( p_cfg->backlog_up && backlog >= p_cfg->backlog_up ) )
+    {
+        p_state->point = 0;
+        p_state->calm = 0;
+        return 0;
+    }
+
+    if( point + 1 < points )
+    {
+        /* kHz keeps the product in 32 bits */
+        projected = (os_uint32_t)load * ( p_hz[point] / 1000 ) / ( p_hz[point + 1] / 1000 );
+        if( projected < p_cfg->target )
+        {
+            if( ++p_state->calm >= p_cfg->hold )
+            {
+                p_state->point = point + 1;
+                p_state->calm = 0;
+            }
+            return p_state->point;
+        }
+    }
+
+    p_state->calm = 0;
+    return point;
+}
+
+#ifdef OS_USING_GOVERNOR
+void governor_init( os_uint8_t task_id )
+{
+    governor_task_id = task_id;
+
+    for( governor_points = 0; governor_points < GOVERNOR_POINT_MAX; governor_points++ )
+    {
+        governor_hz[governor_points] = os_board_clock_hz( governor_points );
+        if( governor_hz[governor_points] == 0 )
+            break;
+    }
+
+    governor_state.point = os_board_clock_get();
+    governor_state.calm = 0;
+
+    os_timer_create( governor_task_id, GOVERNOR_EVT_SAMPLE, OS_LOAD_PERIOD );
+}
+
+/* runs once per load period, right after the sample it looks at has closed */
+void governor_task( os_int8_t event_id )
+{
+    os_uint8_t point;
+
+    OS_ASSERT( event_id == GOVERNOR_EVT_SAMPLE );
+
+    point = governor_decide( &governor_cfg, &governor_state, governor_hz, governor_points,
+                             os_cpu_load( 1 ), os_task_ready_count() );
+    if( point != os_board_clock_get() &&
+        os_board_clock_set( point ) != OS_ERR_NONE )
+    {
+        /* a UART is receiving, stay and decide again next period */
+        governor_state.point = os_board_clock_get();
+    }
+
+    os_timer_create( governor_task_id, GOVERNOR_EVT_SAMPLE, OS_LOAD_PERIOD );
+}
+#endif //OS_USING_GOVERNOR
+
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
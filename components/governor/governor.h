@@ -0,0 +1,58 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ * 
+ ******************************************************************************/
+
+#ifndef __GOVERNOR_H__
+#define __GOVERNOR_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes -------------------------------------------------------------------*/
+/* tools/governor_replay.c builds the policy on the host without the kernel */
+#ifndef GOVERNOR_POLICY_ONLY
+#include "os.h"
+#endif
+
+/* Exported define ------------------------------------------------------------*/
+#define GOVERNOR_POINT_MAX        8
+
+/* Exported typedef -----------------------------------------------------------*/
+typedef struct governor_config {
+    os_uint16_t up;             // permille, at or above it jump to the fastest point
+    os_uint16_t target;         // permille, step down while the load projected at the slower point stays below
+    os_uint8_t hold;            // periods the projection has to hold before a step down
+    os_uint8_t backlog_up;      // ready tasks that force the fastest point, 0 to ignore
+} governor_config_t;
+
+typedef struct governor_state {
+    os_uint8_t point;           // clock point now, 0 is the fastest
+    os_uint8_t calm;            // periods the step down has held so far
+} governor_state_t;
+
+/* Exported macro -------------------------------------------------------------*/
+/* Exported variables ---------------------------------------------------------*/
+/* Exported function prototypes -----------------------------------------------*/
+os_uint8_t governor_decide( const governor_config_t *p_cfg, governor_state_t *p_state,
+                            const os_uint32_t *p_hz, os_uint8_t points,
+                            os_uint16_t load, os_uint8_t backlog );
+
+#ifdef OS_USING_GOVERNOR
+void governor_init( os_uint8_t task_id );
+void governor_task( os_int8_t event_id );
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__GOVERNOR_H__
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
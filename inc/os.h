@@ -60,6 +60,21 @@ extern "C" {
 #define OS_NULL 0
 #endif
 
+#ifndef OS_TASK_MAX
+#define OS_TASK_MAX         32
+#endif
+#if OS_TASK_MAX > 256
+#error "OS_TASK_MAX should not be larger than 256."
+#endif
+
+#define OS_SCHED_POLICY_PRIO        0       // lowest task id first, always
+#define OS_SCHED_POLICY_RR          1       // resume after the task served last
+#define OS_SCHED_POLICY_WFQ         2       // lowest task id first among tasks with credit left
+
+#ifndef OS_SCHED_POLICY
+#define OS_SCHED_POLICY     OS_SCHED_POLICY_PRIO
+#endif
+
 #define OS_ERR_NONE         0
 #define OS_ERR_GENERIC      1
 #define OS_ERR_INVAL        2
@@ -68,6 +83,7 @@ extern "C" {
 #define OS_ERR_EMPTY        5
 #define OS_ERR_BUSY         6
 #define OS_ERR_IO           7
+#define OS_ERR_TIMEOUT      8
 
 #ifdef  OS_MSG_EN
 #define OS_TASK_EVT_MSG     (-1)
@@ -89,11 +105,27 @@ typedef os_uint8_t os_event_t;
 #elif OS_TASK_EVENT_MAX <= 16
 typedef os_uint16_t os_event_t;
 #elif OS_TASK_EVENT_MAX <= 32
-typedef os_uint16_t os_event_t;
+typedef os_uint32_t os_event_t;
 #else
 #error "OS_TASK_EVENT_MAX should not be larger than 32."
 #endif
 
+#if defined(OS_BUDGET_EN) && !defined(OS_CLOCK_EN)
+#error "OS_BUDGET_EN requires OS_CLOCK_EN."
+#endif
+
+#if defined(OS_SCHED_STATS_EN) && !defined(OS_CLOCK_EN)
+#error "OS_SCHED_STATS_EN requires OS_CLOCK_EN."
+#endif
+
+#if defined(OS_CO_EN) && !(defined(OS_TIMER_EN) && defined(OS_MSG_EN))
+#error "OS_CO_EN requires OS_TIMER_EN and OS_MSG_EN."
+#endif
+
+#if defined(OS_TICKLESS_EN) && !defined(OS_CLOCK_EN)
+#error "OS_TICKLESS_EN requires OS_CLOCK_EN."
+#endif
+
 #ifdef OS_CLOCK_EN
 typedef struct os_clock {
     os_uint32_t tick[2];
@@ -102,20 +134,230 @@ typedef struct os_clock {
 
 #ifdef OS_MSG_EN
 typedef struct os_msg {
-    struct os_msg *next;
+    struct os_msg * volatile next;
     os_uint16_t len;
     os_uint8_t from_task_id;
     os_int8_t type;
+#ifdef OS_MSG_MULTICAST_EN
+    os_uint8_t refs;                        // receivers yet to delete it, 0 unless multicast
+#endif
 } OS_MSG_t;
+
+/*
+ *  Intrusive multi-producer single-consumer queue after D. Vyukov. Senders,
+ *  interrupts included, swap themselves in at ptail and then link the node
+ *  they replaced; only the owner task pops at phead. The stub keeps the
+ *  queue from ever being empty, so neither end needs a lock.
+ */
+typedef struct os_msg_queue {
+    OS_MSG_t *phead;
+    OS_MSG_t * volatile ptail;
+    OS_MSG_t stub;
+} OS_MSG_QUEUE_t;
+
+#ifndef OS_MSG_PRIO_MAX
+#define OS_MSG_PRIO_MAX         2           // queues per task, up to 8
+#endif
+#if OS_MSG_PRIO_MAX < 1 || OS_MSG_PRIO_MAX > 8
+#error "OS_MSG_PRIO_MAX should be 1 to 8."
+#endif
+#define OS_MSG_PRIO_URGENT      0           // received first, os_msg_send_urgent()
+#define OS_MSG_PRIO_NORMAL      (OS_MSG_PRIO_MAX - 1)   // received last, os_msg_send()
+
+#ifndef OS_MSG_DEPTH
+#define OS_MSG_DEPTH            32          // messages a task may have queued unless OS_TASK_t.msg_depth says
+#endif
+#if OS_MSG_DEPTH < 1 || OS_MSG_DEPTH > 255
+#error "OS_MSG_DEPTH should be 1 to 255."
+#endif
+
+#ifndef OS_MSG_BATCH
+#define OS_MSG_BATCH            8           // messages handed to a task per scheduler pass unless OS_TASK_t.msg_batch says
+#endif
+#if OS_MSG_BATCH < 1 || OS_MSG_BATCH > 255
+#error "OS_MSG_BATCH should be 1 to 255."
+#endif
+
+/* messages taken by os_msg_recv_all(), walked with os_msg_list_pop() */
+typedef struct os_msg_list {
+    OS_MSG_t *phead;
+    os_uint8_t task_id;
+} OS_MSG_LIST_t;
+
+typedef struct os_msg_stat {
+    os_uint8_t depth;                       // limit of count
+    os_uint8_t count;                       // messages queued now, all levels
+    os_uint8_t count_max;                   // high-water mark of count
+    os_uint16_t drop;                       // sends refused with OS_ERR_FULL
+} OS_MSG_STAT_t;
+#endif
+
+#ifdef OS_MSG_MULTICAST_EN
+#ifndef OS_MSG_EN
+#error "OS_MSG_MULTICAST_EN requires OS_MSG_EN."
+#endif
+#ifndef OS_MSG_REF_MAX
+#define OS_MSG_REF_MAX          8           // multicast deliveries queued at once
+#endif
+
+/* queued in place of a multicast message, one per receiver */
+typedef struct os_msg_ref {
+    OS_MSG_t node;
+    OS_MSG_t *pshared;
+} OS_MSG_REF_t;
+#endif
+
+#ifdef OS_MSG_POOL_EN
+#ifndef OS_MSG_EN
+#error "OS_MSG_POOL_EN requires OS_MSG_EN."
+#endif
+/* blocks per size class, payload bytes, larger messages come from the heap */
+#ifndef OS_MSG_POOL_8
+#define OS_MSG_POOL_8           0
+#endif
+#ifndef OS_MSG_POOL_16
+#define OS_MSG_POOL_16          0
+#endif
+#ifndef OS_MSG_POOL_32
+#define OS_MSG_POOL_32          0
+#endif
+#ifndef OS_MSG_POOL_64
+#define OS_MSG_POOL_64          0
+#endif
+#ifndef OS_MSG_POOL_128
+#define OS_MSG_POOL_128         0
+#endif
+#define OS_MSG_POOL_CLASS_MAX   5
+
+typedef struct os_msg_pool {
+    os_uint16_t size;                       // payload bytes of a block
+    os_uint16_t count;                      // blocks in the pool
+    os_uint16_t used;                       // blocks taken now
+    os_uint16_t used_max;                   // high-water mark of used
+    os_uint16_t miss;                       // requests found the pool empty
+} OS_MSG_POOL_t;
+#endif
+
+#ifdef OS_IDLE_EN
+#ifndef OS_IDLE_WORK_MAX
+#define OS_IDLE_WORK_MAX        4
+#endif
+#define OS_IDLE_DONE            0           // idle work finished, its slot is freed
+#define OS_IDLE_AGAIN           1           // idle work left, called again on a later idle pass
+#endif
+
+#ifdef OS_RPC_EN
+#if !defined(OS_MSG_EN) || !defined(OS_POST_EN) || !defined(OS_CLOCK_EN)
+#error "OS_RPC_EN requires OS_MSG_EN, OS_POST_EN and OS_CLOCK_EN."
+#endif
+#ifndef OS_RPC_MAX
+#define OS_RPC_MAX              4           // calls awaiting their reply at a time
+#endif
+#endif
+
+#ifdef OS_LOAD_EN
+#ifndef OS_CLOCK_EN
+#error "OS_LOAD_EN requires OS_CLOCK_EN."
+#endif
+#ifndef OS_LOAD_PERIOD
+#define OS_LOAD_PERIOD          1000        // ticks per load sample
+#endif
+#ifndef OS_LOAD_HIST_MAX
+#define OS_LOAD_HIST_MAX        60          // samples kept, the longest os_cpu_load() window
+#endif
+#endif
+
+#ifdef OS_PROFILE_EN
+#ifndef OS_CYCLE_COUNTER
+#error "OS_PROFILE_EN requires OS_CYCLE_COUNTER() in os_portable.h."
+#endif
+#ifndef OS_PROFILE_SLOT_MAX
+#define OS_PROFILE_SLOT_MAX     16
+#endif
+#ifndef OS_PROFILE_HIST_MAX
+#define OS_PROFILE_HIST_MAX     16
+#endif
+#ifndef OS_PROFILE_HIST_SHIFT
+#define OS_PROFILE_HIST_SHIFT   6
+#endif
+typedef struct os_profile {
+    os_uint8_t task_id;
+    os_int8_t event_id;
+    os_uint16_t hist[OS_PROFILE_HIST_MAX];  // log2 histogram of the cycles
+    os_uint32_t count;
+    os_uint32_t min;
+    os_uint32_t max;
+    os_uint64_t sum;                        // 64 bits, does not wrap in practice
+} OS_PROFILE_t;
+#endif
+
+#ifdef OS_POST_EN
+typedef struct os_post {
+    os_int8_t event_id;
+    os_uint32_t arg;
+} OS_POST_t;
+#endif
+
+#ifdef OS_MBOX_EN
+#define OS_TASK_EVT_MBOX    (-2)            // a slot of the task's mailbox is full
+
+/*
+ * Ring of slot_max inline slots, each a length word and the data. Declare it
+ * with OS_MBOX_DEFINE() and give it to its task with OS_TASK_t.p_mbox.
+ */
+typedef struct os_mbox {
+    os_uint8_t *p_slot;
+    os_uint16_t slot_size;                  // bytes per slot, OS_MBOX_SLOT_HDR included
+    os_uint8_t slot_max;                    // power of 2, up to 128
+    volatile os_uint8_t head;               // moved by the owner task only
+    volatile os_uint8_t tail;               // moved by the sender only
+    os_uint16_t drop;                       // sends refused with OS_ERR_FULL
+} OS_MBOX_t;
+
+#define OS_MBOX_SLOT_HDR        4           // keeps the data word aligned
+#define OS_MBOX_SLOT_SIZE(size) ( OS_MBOX_SLOT_HDR + ( ( (size) + 3 ) & ~3 ) )
+/* slots of up to size bytes each, e.g. OS_MBOX_DEFINE( demo_mbox, 4, 16 ) in os_config.c */
+#define OS_MBOX_DEFINE(name, slots, size) \
+    typedef char name##_slots_check_t[( (slots) > 0 && (slots) <= 128 && ( (slots) & ( (slots) - 1 ) ) == 0 ) ? 1 : -1]; \
+    static os_uint32_t name##_slot[(slots) * OS_MBOX_SLOT_SIZE(size) / 4]; \
+    static OS_MBOX_t name = { (os_uint8_t *)name##_slot, OS_MBOX_SLOT_SIZE(size), (slots), 0, 0, 0 }
 #endif
 
 typedef struct os_tcb {
 
     os_event_t event;
 
+#ifdef OS_POST_EN
+    os_uint8_t post_head;                   // oldest posted event
+    os_uint8_t post_cnt;
+#endif
+
+#ifdef OS_EVENT_COUNT_EN
+    os_event_t event_ovf;                   // counted events that saturated
+#endif
+
+#ifdef OS_CO_EN
+    os_uint16_t co_line;                    // where the coroutine resumes, 0 at its start
+#endif
+
 #ifdef OS_MSG_EN
-    OS_MSG_t *phead;
-    OS_MSG_t *ptail;
+    OS_MSG_QUEUE_t msgq[OS_MSG_PRIO_MAX];   // level 0 is received first
+    os_uint8_t msg_map;                     // levels that may hold a message
+    os_uint8_t msg_cnt;                     // messages queued, all levels
+    os_uint8_t msg_cnt_max;
+#ifdef OS_CO_EN
+    os_uint8_t msg_hold;                    // coroutine took no message when called for one, not called again until it receives
+#endif
+    os_uint16_t msg_drop;
+#endif
+
+#if OS_SCHED_POLICY == OS_SCHED_POLICY_WFQ
+    os_uint8_t credit;
+#endif
+
+#ifdef OS_SCHED_STATS_EN
+    os_uint32_t ready_tick;
+    os_uint32_t wait_max;
 #endif
 
 } OS_TCB_t;
@@ -123,9 +365,151 @@ typedef struct os_tcb {
 typedef struct os_task {
     void (*p_task_init)( os_uint8_t task_id );
     void (*p_task_handler)( os_int8_t event_id );
+#ifdef OS_EVENT_MASK_EN
+    void (*p_task_handler_mask)( os_event_t events );   // all pending events at once, NULL for one per call
+#endif
+#ifdef OS_BUDGET_EN
+    os_uint16_t budget;                     // ticks one handler call may take, 0 for no limit
+#endif
+#if OS_SCHED_POLICY == OS_SCHED_POLICY_WFQ
+    os_uint8_t weight;                      // dispatches per round, 0 counts as 1
+#endif
+#ifdef OS_POST_EN
+    OS_POST_t *p_post;                      // slots for os_task_post_event(), see OS_POST_SLOTS()
+    os_uint8_t post_max;
+#endif
+#ifdef OS_EVENT_COUNT_EN
+    os_event_t event_counted;               // events counted instead of coalesced, see OS_EVENT_COUNTED()
+    os_uint8_t *p_event_cnt;                // OS_TASK_EVENT_MAX saturating counters
+#endif
+#ifdef OS_URGENT_EN
+    os_uint8_t urgent;                      // run from the urgent level, only for task ids below 32,
+                                            // not for os_clock_set() nor os_defer() to a shared queue
+#endif
+#ifdef OS_MBOX_EN
+    OS_MBOX_t *p_mbox;                      // mailbox the task receives from, see OS_MBOX_DEFINE()
+#endif
+#ifdef OS_CO_EN
+    os_uint8_t co;                          // handler is a coroutine, its messages wait for os_await_msg()
+#endif
+#ifdef OS_MSG_EN
+    os_uint8_t msg_depth;                   // messages it may have queued, 0 for OS_MSG_DEPTH
+    os_uint8_t msg_batch;                   // OS_TASK_EVT_MSG calls per scheduler pass, 0 for OS_MSG_BATCH
+#endif
 } OS_TASK_t;
 
+#ifdef OS_TRACE_EN
+#ifndef OS_TRACE_SIZE
+#define OS_TRACE_SIZE           128
+#endif
+#ifndef OS_TRACE_TIME_HZ
+#define OS_TRACE_TIME_HZ        1000        // rate of OS_TRACE_TIME(), os_systick by default
+#endif
+#define OS_TRACE_DISPATCH_BEGIN 0           // task_id handler called with event arg, or OS_TASK_EVT_MSG
+#define OS_TRACE_DISPATCH_END   1
+#define OS_TRACE_EVENT_SET      2           // task_id was given event arg from a task
+#define OS_TRACE_EVENT_SET_ISR  3           // same from an interrupt
+#define OS_TRACE_TIMER_FIRE     4           // timer of task_id for event arg expired
+#define OS_TRACE_MSG_SEND       5           // message of arg bytes sent to task_id
+#define OS_TRACE_MSG_RECV       6           // message of arg bytes taken by task_id
+#define OS_TRACE_ALLOC          7           // arg bytes taken from the heap by task_id
+#define OS_TRACE_FREE           8           // arg bytes given back to the heap by task_id
+#define OS_TRACE_POST           9           // event arg posted to task_id
+
+typedef struct os_trace_rec {
+    os_uint32_t time;                       // OS_TRACE_TIME()
+    os_uint8_t type;
+    os_uint8_t task_id;
+    os_uint16_t arg;
+} OS_TRACE_REC_t;
+#endif
+
+#ifdef OS_BUDGET_EN
+typedef struct os_budget_log {
+    os_uint8_t task_id;
+    os_int8_t event_id;
+    os_uint32_t tick;                       // how long the handler ran
+} OS_BUDGET_LOG_t;
+#endif
+
 /* Exported macro -------------------------------------------------------------*/
+#ifdef OS_POST_EN
+/* gives a task its post slots in the task table, e.g. { ..., OS_POST_SLOTS(demo_post) } */
+#define OS_POST_SLOTS(slots)    .p_post = (slots), .post_max = (os_uint8_t)(sizeof(slots) / sizeof(OS_POST_t))
+#endif
+
+#ifdef OS_EVENT_COUNT_EN
+/* counts the events in mask for a task in the task table, cnt holds OS_TASK_EVENT_MAX bytes */
+#define OS_EVENT_COUNTED(mask, cnt)     .event_counted = (mask), .p_event_cnt = (cnt)
+#endif
+
+#ifdef OS_CO_EN
+/*
+ *  Stackless coroutine tasks. The task handler body goes between
+ *  OS_CO_BEGIN(event_id) and OS_CO_END(), and each await returns from the
+ *  handler and resumes right after it when the awaited event or message is
+ *  dispatched. Only the resume line is kept, in the TCB, so locals do not
+ *  survive an await (keep them static) and the body must not use switch
+ *  around an await. Set .co in the task table entry: messages that arrive
+ *  while the coroutine awaits something else then stay queued without
+ *  holding up its events, os_await_msg() takes them once it is reached.
+ *
+ *  void demo_task( os_int8_t event_id )
+ *  {
+ *      os_err_t err;
+ *
+ *      OS_CO_BEGIN( event_id );
+ *      led_set( LED_0, LED_ON );
+ *      os_await_timer( DEMO_TASK_EVT_TIMEOUT, 500, err );
+ *      led_set( LED_0, LED_OFF );
+ *      OS_CO_END();
+ *  }
+ */
+#define OS_CO_BEGIN(event_id)                                               \
+    {                                                                       \
+        os_uint16_t *os_co_line = os_task_co_line();                        \
+        os_int8_t os_co_event = (event_id);                                 \
+        (void)os_co_event;                                                  \
+        switch( *os_co_line ) { case 0:
+
+#define OS_CO_END()                                                         \
+        }                                                                   \
+        *os_co_line = 0;                                                    \
+    }
+
+/* returns now and resumes at the next dispatch where cond holds */
+#define OS_CO_WAIT_UNTIL(cond)                                              \
+    do {                                                                    \
+        *os_co_line = __LINE__; return; case __LINE__:                      \
+        if( !(cond) ) return;                                               \
+    } while( 0 )
+
+/* resumes once the event is dispatched to the task */
+#define os_await_event(event)       OS_CO_WAIT_UNTIL( os_co_event == (event) )
+
+/*
+ * starts a one-shot timer for the event, then awaits it. err is set to
+ * OS_ERR_NONE once the timer has fired, or to the os_timer_create() error
+ * at once, without waiting, when no timer could be started.
+ */
+#define os_await_timer(event, tick, err)                                    \
+    do {                                                                    \
+        (err) = os_timer_create( os_get_task_id_self(), (event), (tick) );  \
+        if( (err) == OS_ERR_NONE )                                          \
+        {                                                                   \
+            os_await_event( event );                                        \
+            (err) = OS_ERR_NONE;                                            \
+        }                                                                   \
+    } while( 0 )
+
+/* resumes with the next message in pmsg, at once if one is queued already */
+#define os_await_msg(pmsg)                                                  \
+    do {                                                                    \
+        *os_co_line = __LINE__; case __LINE__:                              \
+        if( ((pmsg) = os_msg_recv( os_get_task_id_self() )) == NULL ) return; \
+    } while( 0 )
+#endif
+
 #ifndef BV
 #define BV(n)      (1 << (n))
 #endif
@@ -216,6 +600,126 @@ typedef struct os_task {
  */
 #define st(x)      do { x } while (__LINE__ == -1)
 
+/*
+ *  Count leading/trailing zeros of a non-zero 32-bit word, used by the
+ *  scheduler to pick the highest priority ready task and its lowest pending
+ *  event in constant time. The port may provide OS_CLZ32() in os_portable.h,
+ *  otherwise the hardware instruction is used where the core has one (M3/M4)
+ *  and a de Bruijn multiply-and-lookup everywhere else (M0/M0+).
+ */
+#ifndef OS_CLZ32
+#if defined(__ICCARM__) && (__CORE__ == __ARM7M__ || __CORE__ == __ARM7EM__)
+#define OS_CLZ32(x)     __CLZ(x)
+#elif defined(__GNUC__) && !defined(__ARM_ARCH_6M__)
+#define OS_CLZ32(x)     ((os_uint8_t)__builtin_clz(x))
+#endif
+#endif
+
+/*
+ *  Orders the memory accesses around a lock-free hand-over between an ISR
+ *  and the scheduler. The port may provide OS_MEMORY_BARRIER() in
+ *  os_portable.h, e.g. __DMB() on Cortex-M.
+ */
+#ifndef OS_MEMORY_BARRIER
+#if defined(__GNUC__)
+#define OS_MEMORY_BARRIER()     __sync_synchronize()
+#else
+#define OS_MEMORY_BARRIER()
+#endif
+#endif
+
+/*
+ *  Critical sections nest, only the outermost OS_ENTER_CRITICAL() masks
+ *  interrupts and only its OS_EXIT_CRITICAL() puts back the mask it found.
+ *  The port provides OS_INT_SAVE(), masking every interrupt allowed to call
+ *  the kernel and returning the previous mask, and OS_INT_RESTORE(state) in
+ *  os_portable.h. A Cortex-M3/M4 port may define OS_KERNEL_BASEPRI instead
+ *  to mask by BASEPRI, interrupts of a higher priority (numerically lower)
+ *  are then never held off and must never call the kernel. Its
+ *  os_board_sleep() has to set PRIMASK and drop BASEPRI around WFI, or the
+ *  masked interrupts cannot wake the core up.
+ */
+#if !defined(OS_INT_SAVE) && defined(OS_KERNEL_BASEPRI)
+#define OS_INT_SAVE()               os_int_save_basepri()
+#define OS_INT_RESTORE(state)       os_int_restore_basepri(state)
+#endif
+#ifndef OS_ENTER_CRITICAL
+#define OS_ENTER_CRITICAL()         os_critical_enter()
+#define OS_EXIT_CRITICAL()          os_critical_exit()
+#endif
+
+/*
+ *  Urgent tasks are dispatched from a software interrupt the port pends with
+ *  OS_URGENT_PEND() and whose handler calls __os_urgent_process(), so they
+ *  preempt the handler main() is running. They use the event, post, message,
+ *  timer, idle work and RPC API like any task. Off-limits there are
+ *  os_clock_set(), which main() updates unguarded, and os_defer() to a queue
+ *  an interrupt priority also fills, since each queue has a single producer.
+ *  Kernel state shared with them is guarded by OS_URGENT_LOCK(), a critical
+ *  section when the urgent level is enabled and nothing otherwise.
+ */
+#ifdef OS_URGENT_EN
+#ifndef OS_URGENT_PEND
+#error "OS_URGENT_EN requires OS_URGENT_PEND() in os_portable.h."
+#endif
+#define OS_URGENT_LOCK()            OS_ENTER_CRITICAL()
+#define OS_URGENT_UNLOCK()          OS_EXIT_CRITICAL()
+#else
+#define OS_URGENT_LOCK()
+#define OS_URGENT_UNLOCK()
+#endif
+
+/*
+ *  Records a kernel trace point when OS_TRACE_EN is defined. OS_IN_ISR()
+ *  from os_portable.h tells events set by interrupts apart, if the port
+ *  has it.
+ */
+#ifdef OS_TRACE_EN
+#define OS_TRACE(type, task_id, arg)    __os_trace( (type), (os_uint8_t)(task_id), (os_uint16_t)(arg) )
+#else
+#define OS_TRACE(type, task_id, arg)
+#endif
+#ifndef OS_IN_ISR
+#define OS_IN_ISR()                 0
+#endif
+
+#if defined(OS_CRITICAL_STATS_EN) && !defined(OS_CYCLE_COUNTER)
+#error "OS_CRITICAL_STATS_EN requires OS_CYCLE_COUNTER() in os_portable.h."
+#endif
+
+/*
+ *  Atomic fetch-and-OR/AND/ADD/SUB on an 8, 16 or 32-bit word shared with
+ *  interrupts, all return the previous value, and a pointer exchange that
+ *  returns the old pointer. The port may provide them in
+ *  os_portable.h, otherwise the GCC __atomic builtins are used where they are
+ *  lock-free (host, M3/M4), LDREX/STREX with IAR on M3/M4 and a short
+ *  critical section everywhere else (M0/M0+).
+ */
+#ifndef OS_ATOMIC_FETCH_OR
+#if defined(__GNUC__) && !defined(__ARM_ARCH_6M__)
+#define OS_ATOMIC_FETCH_OR(p, v)    __atomic_fetch_or( (p), (v), __ATOMIC_SEQ_CST )
+#define OS_ATOMIC_FETCH_AND(p, v)   __atomic_fetch_and( (p), (v), __ATOMIC_SEQ_CST )
+#define OS_ATOMIC_FETCH_ADD(p, v)   __atomic_fetch_add( (p), (v), __ATOMIC_SEQ_CST )
+#define OS_ATOMIC_FETCH_SUB(p, v)   __atomic_fetch_sub( (p), (v), __ATOMIC_SEQ_CST )
+#define OS_ATOMIC_XCHG_PTR(p, v)    __atomic_exchange_n( (p), (v), __ATOMIC_SEQ_CST )
+#else
+#define OS_ATOMIC_SOFT
+#define OS_ATOMIC_FETCH_OR(p, v)    os_atomic_fetch_or( (p), (os_uint32_t)(v), sizeof(*(p)) )
+#define OS_ATOMIC_FETCH_AND(p, v)   os_atomic_fetch_and( (p), (os_uint32_t)(v), sizeof(*(p)) )
+#define OS_ATOMIC_FETCH_ADD(p, v)   os_atomic_fetch_add( (p), (os_uint32_t)(v), sizeof(*(p)) )
+#define OS_ATOMIC_FETCH_SUB(p, v)   os_atomic_fetch_add( (p), 0 - (os_uint32_t)(v), sizeof(*(p)) )
+#define OS_ATOMIC_XCHG_PTR(p, v)    os_atomic_xchg_ptr( (p), (v) )
+#endif
+#endif
+
+#ifdef OS_CLZ32
+#define OS_CTZ32(x)     ((os_uint8_t)(31 - OS_CLZ32((x) & (0 - (x)))))
+#else
+#define OS_CLZ32_SOFT
+#define OS_CLZ32(x)     os_clz32(x)
+#define OS_CTZ32(x)     os_ctz32(x)
+#endif
+
 
 #ifndef OS_ASSERT_EN
 #define OS_ASSERT(expr)                        
@@ -255,16 +759,108 @@ typedef struct os_task {
 void os_task_set_event( os_uint8_t task_id, os_int8_t event_id );
 void os_task_clr_event( os_uint8_t task_id, os_int8_t event_id );
 os_uint8_t os_get_task_id_self( void );
+#ifdef OS_CO_EN
+os_uint16_t *os_task_co_line( void );
+#endif
+#ifdef OS_EVENT_COUNT_EN
+os_uint8_t os_task_event_count( os_int8_t event_id );
+os_event_t os_task_event_overflow( os_uint8_t task_id );
+#endif
+#ifdef OS_POST_EN
+os_err_t os_task_post_event( os_uint8_t task_id, os_int8_t event_id, os_uint32_t arg );
+os_uint32_t os_task_event_arg( void );
+#endif
+#ifdef OS_SCHED_STATS_EN
+os_uint32_t os_task_wait_max( os_uint8_t task_id );
+void os_task_wait_max_reset( os_uint8_t task_id );
+#endif
+os_uint8_t os_task_ready_count( void );
+os_uint8_t os_clz32( os_uint32_t x );
+os_uint8_t os_ctz32( os_uint32_t x );
+#ifdef OS_INT_SAVE
+void os_critical_enter( void );
+void os_critical_exit( void );
+#ifdef OS_CRITICAL_STATS_EN
+os_uint32_t os_critical_max_get( void );
+void os_critical_max_reset( void );
+#endif
+#ifdef OS_KERNEL_BASEPRI
+os_uint32_t os_int_save_basepri( void );
+void os_int_restore_basepri( os_uint32_t state );
+#endif
+#endif
+#ifdef OS_ATOMIC_SOFT
+os_uint32_t os_atomic_fetch_or( volatile void *p, os_uint32_t v, os_uint8_t size );
+os_uint32_t os_atomic_fetch_and( volatile void *p, os_uint32_t v, os_uint8_t size );
+os_uint32_t os_atomic_fetch_add( volatile void *p, os_uint32_t v, os_uint8_t size );
+void *os_atomic_xchg_ptr( volatile void *p, void *v );
+#endif
 
 #ifdef OS_MSG_EN
 void *os_msg_create( os_uint16_t len, os_int8_t type );
 void os_msg_delete ( void *pmsg );
-void os_msg_send( void *pmsg, os_uint8_t task_id );
-void os_msg_send_urgent ( void *pmsg, os_uint8_t task_id );
+os_err_t os_msg_send( void *pmsg, os_uint8_t task_id );
+os_err_t os_msg_send_urgent ( void *pmsg, os_uint8_t task_id );
+os_err_t os_msg_send_prio( void *pmsg, os_uint8_t task_id, os_uint8_t prio );
+#ifdef OS_MSG_MULTICAST_EN
+os_err_t os_msg_send_multi( void *pmsg, const os_uint8_t *p_task_id, os_uint8_t count );
+#endif
 void *os_msg_recv( os_uint8_t task_id );
+os_uint8_t os_msg_recv_all( os_uint8_t task_id, OS_MSG_LIST_t *p_list );
+void *os_msg_list_pop( OS_MSG_LIST_t *p_list );
 os_uint16_t os_msg_len( void *pmsg );
 os_int8_t os_msg_type( void *pmsg );
 os_uint8_t os_msg_from( void *pmsg );
+os_err_t os_msg_stat_get( os_uint8_t task_id, OS_MSG_STAT_t *p_stat );
+#endif
+
+#ifdef OS_MSG_POOL_EN
+os_err_t os_msg_pool_get( os_uint8_t index, OS_MSG_POOL_t *p_pool );
+#endif
+
+#ifdef OS_DEFER_EN
+os_err_t os_defer( os_uint8_t prio, void (*p_fxn)( os_uint32_t arg ), os_uint32_t arg );
+#endif
+
+#ifdef OS_IDLE_EN
+os_err_t os_idle_work_submit( os_uint8_t (*p_fxn)( os_uint32_t arg ), os_uint32_t arg );
+#endif
+
+#ifdef OS_MBOX_EN
+os_err_t os_mbox_send( os_uint8_t task_id, const void *pdata, os_uint16_t len );
+void *os_mbox_recv( os_uint8_t task_id, os_uint16_t *p_len );
+void os_mbox_release( os_uint8_t task_id );
+os_err_t os_mbox_stat_get( os_uint8_t task_id, os_uint8_t *p_count, os_uint16_t *p_drop );
+#endif
+
+#ifdef OS_RPC_EN
+os_uint16_t os_rpc_call( os_uint8_t task_id, void *preq, os_uint32_t timeout, os_int8_t event_id );
+os_err_t os_rpc_reply( void *preq, void *prsp );
+os_err_t os_rpc_result( os_uint16_t id, void **pp_rsp );
+#endif
+
+#ifdef OS_LOAD_EN
+os_uint16_t os_cpu_load( os_uint8_t periods );
+os_err_t os_cpu_load_get( os_uint8_t index, os_uint16_t *p_permille );
+#endif
+
+#ifdef OS_PROFILE_EN
+void os_profile_reset( void );
+os_err_t os_profile_get( os_uint8_t index, OS_PROFILE_t *p_profile );
+os_uint32_t os_profile_missed_get( void );
+#endif
+
+#ifdef OS_TRACE_EN
+os_uint8_t os_trace_enable( os_uint8_t enable );
+void os_trace_clear( void );
+os_uint16_t os_trace_count( void );
+os_err_t os_trace_get( os_uint16_t index, OS_TRACE_REC_t *p_rec );
+void __os_trace( os_uint8_t type, os_uint8_t task_id, os_uint16_t arg );
+#endif
+
+#ifdef OS_BUDGET_EN
+os_err_t os_budget_log_get( os_uint8_t index, OS_BUDGET_LOG_t *p_log );
+os_uint32_t os_budget_overrun_cnt( void );
 #endif
 
 #ifdef OS_CLOCK_EN
@@ -0,0 +1,129 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/* Includes ------------------------------------------------------------------*/
+#include "os.h"
+
+#ifdef OS_BUDGET_EN
+
+/* Exported variables --------------------------------------------------------*/
+extern const OS_TASK_t *os_task_list;
+extern volatile os_uint32_t os_systick;
+
+/* Private define ------------------------------------------------------------*/
+#define OS_BUDGET_TASK_NONE     UINT8_MAX
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* the handler in progress, watched from the tick interrupt */
+static volatile os_uint8_t os_budget_task_id = OS_BUDGET_TASK_NONE;
+static volatile os_int8_t os_budget_event_id;
+static volatile os_uint32_t os_budget_start;
+static volatile os_uint8_t os_budget_overrun;
+
+static OS_BUDGET_LOG_t os_budget_log[OS_BUDGET_LOG_SIZE];
+static os_uint8_t os_budget_log_index;      // entry of the handler in progress
+static volatile os_uint8_t os_budget_log_next;
+static volatile os_uint32_t os_budget_log_cnt;
+
+/* Private function prototypes -----------------------------------------------*/
+void __os_budget_begin( os_uint8_t task_id, os_int8_t event_id );
+void __os_budget_end( void );
+void __os_budget_check( void );
+
+/* Exported function implementations -----------------------------------------*/
+/* index 0 is the most recent overrun, returns OS_ERR_EMPTY past the last one */
+os_err_t os_budget_log_get( os_uint8_t index, OS_BUDGET_LOG_t *p_log )
+{
+    os_uint8_t i;
+
+    OS_ASSERT( p_log != NULL );
+
+    if( index >= OS_BUDGET_LOG_SIZE || index >= os_budget_log_cnt )
+        return OS_ERR_EMPTY;
+
+    i = ( os_budget_log_next + OS_BUDGET_LOG_SIZE - 1 - index ) % OS_BUDGET_LOG_SIZE;
+    OS_ENTER_CRITICAL();
+    *p_log = os_budget_log[i];
+    OS_EXIT_CRITICAL();
+
+    return OS_ERR_NONE;
+}
+
+/* overruns since power on, including those pushed out of the log */
+os_uint32_t os_budget_overrun_cnt( void )
+{
+    return os_budget_log_cnt;
+}
+
+/* Private function implementations ------------------------------------------*/
+void __os_budget_begin( os_uint8_t task_id, os_int8_t event_id )
+{
+    os_budget_event_id = event_id;
+    os_budget_start = os_systick;
+    os_budget_overrun = FALSE;
+    /* arm the watch last, the tick interrupt keys off the task id */
+    OS_MEMORY_BARRIER();
+    os_budget_task_id = task_id;
+}
+
+void __os_budget_end( void )
+{
+    os_uint32_t tick;
+
+    os_budget_task_id = OS_BUDGET_TASK_NONE;
+    OS_MEMORY_BARRIER();
+
+    if( os_budget_overrun )
+    {
+        /* replace the duration seen by the tick interrupt with the final one */
+        tick = os_systick - os_budget_start;
+        OS_ENTER_CRITICAL();
+        os_budget_log[os_budget_log_index].tick = tick;
+        OS_EXIT_CRITICAL();
+    }
+}
+
+/* called from the tick interrupt while a handler may still be running */
+void __os_budget_check( void )
+{
+    os_uint8_t task_id;
+    os_uint32_t tick;
+    OS_BUDGET_LOG_t *p_log;
+
+    task_id = os_budget_task_id;
+    if( task_id == OS_BUDGET_TASK_NONE || os_budget_overrun )
+        return;
+
+    if( os_task_list[task_id].budget == 0 )
+        return;
+
+    tick = os_systick - os_budget_start;
+    if( tick <= os_task_list[task_id].budget )
+        return;
+
+    os_budget_overrun = TRUE;
+    os_budget_log_index = os_budget_log_next;
+    p_log = &os_budget_log[os_budget_log_index];
+    p_log->task_id = task_id;
+    p_log->event_id = os_budget_event_id;
+    p_log->tick = tick;
+    os_budget_log_next = ( os_budget_log_next + 1 ) % OS_BUDGET_LOG_SIZE;
+    os_budget_log_cnt++;
+
+#ifdef OS_BUDGET_HOOK
+    OS_BUDGET_HOOK( task_id, os_budget_event_id, tick );
+#endif
+}
+
+#endif //OS_BUDGET_EN
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
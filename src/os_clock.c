@@ -14,17 +14,21 @@
 
 #ifdef OS_CLOCK_EN
 /* Exported variables --------------------------------------------------------*/
-os_uint8_t os_systick;
+volatile os_uint32_t os_systick;
 /* Private define ------------------------------------------------------------*/
 /* Private typedef -----------------------------------------------------------*/
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 static OS_CLOCK_t sysclock;
-static os_uint8_t prev_systick;
+static os_uint32_t prev_systick;
 
 /* Private function prototypes -----------------------------------------------*/
 void __os_clock_init( void );
-os_uint8_t __os_clock_update( void );
+os_uint32_t __os_clock_update( void );
+#ifdef OS_TICKLESS_EN
+void __os_clock_credit( os_uint32_t delta_systick );
+os_uint32_t __os_clock_pending( void );
+#endif
 
 /* Exported function implementations -----------------------------------------*/
 void os_clock_get     ( OS_CLOCK_t *clock )
@@ -50,10 +54,10 @@ void __os_clock_init( void )
     os_systick = 0;
 }
 
-os_uint8_t __os_clock_update( void )
+os_uint32_t __os_clock_update( void )
 {
-    os_uint8_t curr_systick;
-    os_uint8_t delta_systick = 0;
+    os_uint32_t curr_systick;
+    os_uint32_t delta_systick = 0;
     
     OS_ENTER_CRITICAL();
     curr_systick = os_systick;
@@ -61,16 +65,38 @@ os_uint8_t __os_clock_update( void )
 
     if( curr_systick != prev_systick )
     {
-        delta_systick = ( curr_systick > prev_systick ) ? ( curr_systick - prev_systick ) : ( UINT8_MAX - prev_systick + curr_systick );
+        /* 32-bit tick counter, no delta is lost behind a long handler */
+        delta_systick = curr_systick - prev_systick;
         prev_systick = curr_systick;
 
-        if( (UINT32_MAX - sysclock.tick[0]) < (os_uint32_t)delta_systick )
+        if( (UINT32_MAX - sysclock.tick[0]) < delta_systick )
             sysclock.tick[1]++;
         sysclock.tick[0] += delta_systick;
     }
     return delta_systick;
 }
 
+#ifdef OS_TICKLESS_EN
+/*
+ * Accounts for ticks slept with the periodic SysTick stopped, called with
+ * interrupts masked. Everything that counts time in os_systick sees them,
+ * __os_clock_update() passes them on to sysclock and the timers.
+ */
+void __os_clock_credit( os_uint32_t delta_systick )
+{
+    os_systick += delta_systick;
+}
+
+/*
+ * Ticks counted in os_systick since the last __os_clock_update(), not yet
+ * seen by the timers. Called with interrupts masked.
+ */
+os_uint32_t __os_clock_pending( void )
+{
+    return os_systick - prev_systick;
+}
+#endif
+
 #endif /* (OS_CLOCK_EN > 0) */
 /****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
 
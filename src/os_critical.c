@@ -0,0 +1,129 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/* Includes ------------------------------------------------------------------*/
+#include "os.h"
+
+#ifdef OS_INT_SAVE
+
+/* Exported variables --------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* Private typedef -----------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/*
+ * Only touched with the kernel interrupts masked. An interrupt that may call
+ * the kernel can only run while the nesting count is 0, and it brings the
+ * count back to 0 before it returns.
+ */
+static os_uint8_t os_critical_nest;
+static os_uint32_t os_critical_state;
+
+#ifdef OS_CRITICAL_STATS_EN
+static os_uint32_t os_critical_start;
+static os_uint32_t os_critical_max;
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+void __os_critical_restart( void );
+
+/* Exported function implementations -----------------------------------------*/
+void os_critical_enter( void )
+{
+    os_uint32_t state;
+
+    state = OS_INT_SAVE();
+    if( os_critical_nest++ == 0 )
+    {
+        os_critical_state = state;
+#ifdef OS_CRITICAL_STATS_EN
+        os_critical_start = OS_CYCLE_COUNTER();
+#endif
+    }
+    OS_ASSERT( os_critical_nest != 0 );
+}
+
+void os_critical_exit( void )
+{
+#ifdef OS_CRITICAL_STATS_EN
+    os_uint32_t cycles;
+#endif
+
+    OS_ASSERT( os_critical_nest != 0 );
+    if( --os_critical_nest == 0 )
+    {
+#ifdef OS_CRITICAL_STATS_EN
+        cycles = OS_CYCLE_COUNTER() - os_critical_start;
+        if( cycles > os_critical_max )
+        {
+            os_critical_max = cycles;
+        }
+#endif
+        OS_INT_RESTORE( os_critical_state );
+    }
+}
+
+#ifdef OS_CRITICAL_STATS_EN
+/* longest outermost critical section so far, in OS_CYCLE_COUNTER() cycles */
+os_uint32_t os_critical_max_get( void )
+{
+    return os_critical_max;
+}
+
+void os_critical_max_reset( void )
+{
+    os_critical_max = 0;
+}
+#endif
+
+#ifdef OS_KERNEL_BASEPRI
+os_uint32_t os_int_save_basepri( void )
+{
+    os_uint32_t state;
+
+#if defined(__ICCARM__)
+    state = __get_BASEPRI();
+    __set_BASEPRI( OS_KERNEL_BASEPRI );
+#else
+    os_uint32_t basepri = OS_KERNEL_BASEPRI;
+
+    __asm volatile ( "mrs %0, basepri" : "=r" (state) );
+    __asm volatile ( "msr basepri, %0\n isb" : : "r" (basepri) : "memory" );
+#endif
+
+    return state;
+}
+
+void os_int_restore_basepri( os_uint32_t state )
+{
+#if defined(__ICCARM__)
+    __set_BASEPRI( state );
+#else
+    __asm volatile ( "msr basepri, %0" : : "r" (state) : "memory" );
+#endif
+}
+#endif
+
+/* Private function implementations ------------------------------------------*/
+/*
+ * Starts timing the current section again, for the scheduler to leave the
+ * time spent asleep inside its idle section out of os_critical_max_get().
+ */
+void __os_critical_restart( void )
+{
+#ifdef OS_CRITICAL_STATS_EN
+    os_critical_start = OS_CYCLE_COUNTER();
+#endif
+}
+
+#endif /* OS_INT_SAVE */
+
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
@@ -0,0 +1,122 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/* Includes ------------------------------------------------------------------*/
+#include "os.h"
+
+#ifdef OS_DEFER_EN
+
+/* Exported variables --------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define OS_DEFER_QUEUE_MASK     (OS_DEFER_QUEUE_SIZE - 1)
+
+#if (OS_DEFER_QUEUE_SIZE & OS_DEFER_QUEUE_MASK) || (OS_DEFER_QUEUE_SIZE > 32768)
+#error "OS_DEFER_QUEUE_SIZE should be a power of 2 and not larger than 32768."
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct os_defer_item {
+    void (*p_fxn)( os_uint32_t arg );
+    os_uint32_t arg;
+} OS_DEFER_ITEM_t;
+
+/*
+ * Single-producer single-consumer ring. The ISRs sharing one interrupt
+ * priority cannot preempt each other so they are the single producer and
+ * only move tail, the scheduler is the single consumer and only moves head.
+ */
+typedef struct os_defer_queue {
+    volatile os_uint16_t head;
+    volatile os_uint16_t tail;
+    OS_DEFER_ITEM_t item[OS_DEFER_QUEUE_SIZE];
+} OS_DEFER_QUEUE_t;
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static OS_DEFER_QUEUE_t os_defer_queue[OS_DEFER_PRIO_MAX];
+
+/* Private function prototypes -----------------------------------------------*/
+void __os_defer_init( void );
+void __os_defer_process( void );
+os_uint8_t __os_defer_pending( void );
+
+/* Exported function implementations -----------------------------------------*/
+os_err_t os_defer( os_uint8_t prio, void (*p_fxn)( os_uint32_t arg ), os_uint32_t arg )
+{
+    OS_DEFER_QUEUE_t *p_queue;
+    os_uint16_t tail;
+
+    OS_ASSERT( prio < OS_DEFER_PRIO_MAX && p_fxn != NULL );
+
+    p_queue = &os_defer_queue[prio];
+    tail = p_queue->tail;
+    if( (os_uint16_t)( tail - p_queue->head ) >= OS_DEFER_QUEUE_SIZE )
+    {
+        return OS_ERR_FULL;
+    }
+
+    p_queue->item[tail & OS_DEFER_QUEUE_MASK].p_fxn = p_fxn;
+    p_queue->item[tail & OS_DEFER_QUEUE_MASK].arg = arg;
+    /* publish the item before the new tail */
+    OS_MEMORY_BARRIER();
+    p_queue->tail = tail + 1;
+
+    return OS_ERR_NONE;
+}
+
+/* Private function implementations ------------------------------------------*/
+void __os_defer_init( void )
+{
+    os_memset( os_defer_queue, 0, sizeof(os_defer_queue) );
+}
+
+void __os_defer_process( void )
+{
+    OS_DEFER_QUEUE_t *p_queue;
+    os_uint8_t prio;
+    os_uint16_t head;
+    void (*p_fxn)( os_uint32_t arg );
+    os_uint32_t arg;
+
+    for( prio = 0; prio < OS_DEFER_PRIO_MAX; prio++ )
+    {
+        p_queue = &os_defer_queue[prio];
+        head = p_queue->head;
+        while( head != p_queue->tail )
+        {
+            OS_MEMORY_BARRIER();
+            p_fxn = p_queue->item[head & OS_DEFER_QUEUE_MASK].p_fxn;
+            arg = p_queue->item[head & OS_DEFER_QUEUE_MASK].arg;
+            /* hand the slot back before running the work item */
+            OS_MEMORY_BARRIER();
+            p_queue->head = ++head;
+            p_fxn( arg );
+        }
+    }
+}
+
+os_uint8_t __os_defer_pending( void )
+{
+    os_uint8_t prio;
+
+    for( prio = 0; prio < OS_DEFER_PRIO_MAX; prio++ )
+    {
+        if( os_defer_queue[prio].head != os_defer_queue[prio].tail )
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+#endif //OS_DEFER_EN
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
@@ -0,0 +1,130 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/* Includes ------------------------------------------------------------------*/
+#include "os.h"
+
+#ifdef OS_IDLE_EN
+
+/* Exported variables --------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#if (OS_IDLE_WORK_MAX == 0) || (OS_IDLE_WORK_MAX > 32)
+#error "OS_IDLE_WORK_MAX should be between 1 and 32."
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct os_idle_work {
+    os_uint8_t (*p_fxn)( os_uint32_t arg );
+    os_uint32_t arg;
+} OS_IDLE_WORK_t;
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static OS_IDLE_WORK_t os_idle_work[OS_IDLE_WORK_MAX];
+static volatile os_uint32_t os_idle_used;   // slots holding work
+static volatile os_uint32_t os_idle_again;  // resubmitted while running
+static os_uint8_t os_idle_next;             // round robin cursor
+
+/* Private function prototypes -----------------------------------------------*/
+os_uint8_t __os_idle_process( void );
+os_uint8_t __os_idle_pending( void );
+
+/* Exported function implementations -----------------------------------------*/
+/*
+ * Queues p_fxn to run when no task is ready. p_fxn does one bounded slice per
+ * call and returns OS_IDLE_AGAIN while work is left, or OS_IDLE_DONE. The same
+ * p_fxn and arg submitted again before it is done is merged into one item.
+ * Callable from tasks and interrupts, returns OS_ERR_FULL without a free slot.
+ */
+os_err_t os_idle_work_submit( os_uint8_t (*p_fxn)( os_uint32_t arg ), os_uint32_t arg )
+{
+    os_uint8_t i;
+    os_uint8_t slot = OS_IDLE_WORK_MAX;
+
+    OS_ASSERT( p_fxn != NULL );
+
+    OS_ENTER_CRITICAL();
+    for( i = 0; i < OS_IDLE_WORK_MAX; i++ )
+    {
+        if( !( os_idle_used & ( 1UL << i ) ) )
+        {
+            if( slot == OS_IDLE_WORK_MAX )
+                slot = i;
+        }
+        else if( os_idle_work[i].p_fxn == p_fxn && os_idle_work[i].arg == arg )
+        {
+            /* a slice running now may miss what the caller just queued */
+            os_idle_again |= 1UL << i;
+            OS_EXIT_CRITICAL();
+            return OS_ERR_NONE;
+        }
+    }
+
+    if( slot == OS_IDLE_WORK_MAX )
+    {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_FULL;
+    }
+
+    os_idle_work[slot].p_fxn = p_fxn;
+    os_idle_work[slot].arg = arg;
+    os_idle_used |= 1UL << slot;
+    OS_EXIT_CRITICAL();
+
+    return OS_ERR_NONE;
+}
+
+/* Private function implementations ------------------------------------------*/
+/*
+ * Runs one slice of the next work item, round robin. Returns FALSE when the
+ * queue is empty so the scheduler may sleep.
+ */
+os_uint8_t __os_idle_process( void )
+{
+    os_uint8_t i;
+    os_uint8_t (*p_fxn)( os_uint32_t arg );
+    os_uint32_t arg;
+
+    if( !os_idle_used )
+        return FALSE;
+
+    i = os_idle_next;
+    while( !( os_idle_used & ( 1UL << i ) ) )
+    {
+        i = ( i + 1 ) % OS_IDLE_WORK_MAX;
+    }
+    os_idle_next = ( i + 1 ) % OS_IDLE_WORK_MAX;
+
+    /* the slot stays taken while p_fxn runs, submit only adds and merges */
+    p_fxn = os_idle_work[i].p_fxn;
+    arg = os_idle_work[i].arg;
+    OS_ATOMIC_FETCH_AND( &os_idle_again, ~( 1UL << i ) );
+
+    if( p_fxn( arg ) == OS_IDLE_DONE )
+    {
+        OS_ENTER_CRITICAL();
+        if( !( os_idle_again & ( 1UL << i ) ) )
+        {
+            os_idle_used &= ~( 1UL << i );
+        }
+        OS_EXIT_CRITICAL();
+    }
+
+    return TRUE;
+}
+
+os_uint8_t __os_idle_pending( void )
+{
+    return os_idle_used != 0;
+}
+
+#endif //OS_IDLE_EN
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
@@ -0,0 +1,170 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/* Includes ------------------------------------------------------------------*/
+#include "os.h"
+
+#ifdef OS_LOAD_EN
+
+/* Exported variables --------------------------------------------------------*/
+extern volatile os_uint32_t os_systick;
+
+/* Private define ------------------------------------------------------------*/
+/*
+ * Has to keep counting while the core sleeps and must not wrap within one
+ * handler call or one sleep, time is summed interval by interval. A port
+ * whose cycle counter stops in WFI overrides it.
+ */
+#ifndef OS_LOAD_TIME
+#ifdef OS_CYCLE_COUNTER
+#define OS_LOAD_TIME()          OS_CYCLE_COUNTER()
+#else
+#define OS_LOAD_TIME()          os_systick
+#endif
+#endif
+
+#if (OS_LOAD_HIST_MAX == 0) || (OS_LOAD_HIST_MAX > 255)
+#error "OS_LOAD_HIST_MAX should be between 1 and 255."
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static os_uint32_t os_load_busy;            // busy time in the current period
+static os_uint32_t os_load_idle;            // idle time in the current period
+static os_uint32_t os_load_mark;            // OS_LOAD_TIME() at the last switch between the two
+static os_uint32_t os_load_start_tick;      // os_systick at the period start
+static os_uint16_t os_load_hist[OS_LOAD_HIST_MAX];  // permille per period, newest at os_load_next - 1
+static os_uint8_t os_load_next;
+static os_uint8_t os_load_cnt;
+
+/* Private function prototypes -----------------------------------------------*/
+void __os_load_init( void );
+void __os_load_update( void );
+void __os_load_idle_begin( void );
+void __os_load_idle_end( void );
+
+/* Exported function implementations -----------------------------------------*/
+/*
+ * Busy share of the last periods OS_LOAD_PERIOD ticks long, in permille.
+ * Averages what has been measured so far when fewer periods have passed.
+ */
+os_uint16_t os_cpu_load( os_uint8_t periods )
+{
+    os_uint32_t sum = 0;
+    os_uint8_t index;
+    os_uint8_t i;
+
+    OS_ASSERT( periods > 0 && periods <= OS_LOAD_HIST_MAX );
+
+    OS_ENTER_CRITICAL();
+    periods = MIN( periods, os_load_cnt );
+    index = os_load_next;
+    for( i = 0; i < periods; i++ )
+    {
+        index = ( index == 0 ) ? OS_LOAD_HIST_MAX - 1 : index - 1;
+        sum += os_load_hist[index];
+    }
+    OS_EXIT_CRITICAL();
+
+    return periods ? (os_uint16_t)( sum / periods ) : 0;
+}
+
+/* index 0 is the oldest sample kept, returns OS_ERR_EMPTY past the newest one */
+os_err_t os_cpu_load_get( os_uint8_t index, os_uint16_t *p_permille )
+{
+    OS_ASSERT( p_permille != NULL );
+
+    OS_ENTER_CRITICAL();
+    if( index >= os_load_cnt )
+    {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_EMPTY;
+    }
+    index = ( os_load_next + OS_LOAD_HIST_MAX - os_load_cnt + index ) % OS_LOAD_HIST_MAX;
+    *p_permille = os_load_hist[index];
+    OS_EXIT_CRITICAL();
+
+    return OS_ERR_NONE;
+}
+
+/* Private function implementations ------------------------------------------*/
+void __os_load_init( void )
+{
+    os_load_busy = 0;
+    os_load_idle = 0;
+    os_load_next = 0;
+    os_load_cnt = 0;
+    os_load_mark = OS_LOAD_TIME();
+    os_load_start_tick = os_systick;
+}
+
+/*
+ * Closes the period once OS_LOAD_PERIOD ticks have passed, called every
+ * scheduler pass. os_systick includes the ticks slept in tickless idle, so a
+ * period ends on time however long the core has slept.
+ */
+void __os_load_update( void )
+{
+    os_uint32_t ticks;
+    os_uint32_t now;
+    os_uint32_t elapsed;
+    os_uint16_t permille;
+    os_uint32_t periods;
+
+    ticks = os_systick - os_load_start_tick;
+    if( ticks < OS_LOAD_PERIOD )
+        return;
+
+    now = OS_LOAD_TIME();
+    os_load_busy += now - os_load_mark;
+    os_load_mark = now;
+    elapsed = os_load_busy + os_load_idle;
+    if( elapsed >= 1000 )
+        permille = (os_uint16_t)MIN( os_load_busy / ( elapsed / 1000 ), 1000 );
+    else
+        permille = elapsed ? (os_uint16_t)( os_load_busy * 1000 / elapsed ) : 0;
+
+    /* a sleep ending past several period boundaries gives each of them its load */
+    periods = MIN( ticks / OS_LOAD_PERIOD, OS_LOAD_HIST_MAX );
+    OS_ENTER_CRITICAL();
+    while( periods-- )
+    {
+        os_load_hist[os_load_next] = permille;
+        os_load_next = ( os_load_next + 1 ) % OS_LOAD_HIST_MAX;
+        if( os_load_cnt < OS_LOAD_HIST_MAX )
+            os_load_cnt++;
+    }
+    OS_EXIT_CRITICAL();
+
+    os_load_busy = 0;
+    os_load_idle = 0;
+    os_load_start_tick += ticks - ticks % OS_LOAD_PERIOD;
+}
+
+void __os_load_idle_begin( void )
+{
+    os_uint32_t now = OS_LOAD_TIME();
+
+    os_load_busy += now - os_load_mark;
+    os_load_mark = now;
+}
+
+void __os_load_idle_end( void )
+{
+    os_uint32_t now = OS_LOAD_TIME();
+
+    os_load_idle += now - os_load_mark;
+    os_load_mark = now;
+}
+
+#endif //OS_LOAD_EN
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
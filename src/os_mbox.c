@@ -0,0 +1,168 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/*
+ * Mailboxes that need no allocator. Each one is a ring of fixed-size slots
+ * declared with OS_MBOX_DEFINE() in os_config.c and owned by the task whose
+ * OS_TASK_t.p_mbox points to it. os_mbox_send() copies into a slot, the task
+ * is called with OS_TASK_EVT_MBOX while a slot is full and reads it in place
+ * until os_mbox_release().
+ *
+ *  OS_MBOX_DEFINE( adc_mbox, 4, sizeof(adc_sample_t) );
+ *  { .p_task_init = adc_init, .p_task_handler = adc_task, .p_mbox = &adc_mbox },
+ *
+ *  void adc_task( os_int8_t event_id )
+ *  {
+ *      adc_sample_t *p_sample;
+ *
+ *      if( event_id == OS_TASK_EVT_MBOX )
+ *      {
+ *          p_sample = os_mbox_recv( adc_task_id, NULL );
+ *          ...
+ *          os_mbox_release( adc_task_id );
+ *      }
+ *  }
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "os.h"
+
+#ifdef OS_MBOX_EN
+
+/* Exported variables --------------------------------------------------------*/
+extern const OS_TASK_t *os_task_list;
+extern const os_uint8_t os_task_max;
+extern OS_TCB_t *os_task_tcb;
+
+/* Private define ------------------------------------------------------------*/
+/* Private typedef -----------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+#define OS_MBOX_SLOT(p_mbox, index) \
+    ( (p_mbox)->p_slot + (os_uint32_t)( (index) & ( (p_mbox)->slot_max - 1 ) ) * (p_mbox)->slot_size )
+
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+os_uint8_t __os_mbox_pending( os_uint8_t task_id );
+extern void __os_task_ready_set( os_uint8_t task_id );
+extern void __os_task_ready_clr( os_uint8_t task_id );
+
+/* Exported function implementations -----------------------------------------*/
+/*
+ * Copies len bytes into the next free slot of the task's mailbox, OS_ERR_FULL
+ * if every slot is taken. Safe from interrupts. A mailbox has one sender,
+ * or senders that cannot preempt each other such as the ISRs of one
+ * interrupt priority, since only the sender moves its tail.
+ */
+os_err_t os_mbox_send( os_uint8_t task_id, const void *pdata, os_uint16_t len )
+{
+    OS_MBOX_t *p_mbox;
+    os_uint8_t *p_slot;
+    os_uint8_t tail;
+
+    OS_ASSERT( task_id < os_task_max );
+    p_mbox = os_task_list[task_id].p_mbox;
+    OS_ASSERT( p_mbox != NULL );
+    OS_ASSERT( len <= p_mbox->slot_size - OS_MBOX_SLOT_HDR );
+
+    tail = p_mbox->tail;
+    if( (os_uint8_t)( tail - p_mbox->head ) >= p_mbox->slot_max )
+    {
+        p_mbox->drop++;
+        return OS_ERR_FULL;
+    }
+
+    p_slot = OS_MBOX_SLOT( p_mbox, tail );
+    *(os_uint16_t *)p_slot = len;
+    os_memcpy( p_slot + OS_MBOX_SLOT_HDR, pdata, len );
+    /* publish the slot before the new tail */
+    OS_MEMORY_BARRIER();
+    p_mbox->tail = tail + 1;
+
+    __os_task_ready_set( task_id );
+    return OS_ERR_NONE;
+}
+
+/*
+ * The oldest full slot of the task's mailbox, NULL if it is empty. It stays
+ * valid, and os_mbox_recv() keeps returning it, until os_mbox_release().
+ * p_len may be NULL. Only the owner task may receive, task context only.
+ */
+void *os_mbox_recv( os_uint8_t task_id, os_uint16_t *p_len )
+{
+    OS_MBOX_t *p_mbox;
+    os_uint8_t *p_slot;
+
+    OS_ASSERT( task_id < os_task_max );
+    p_mbox = os_task_list[task_id].p_mbox;
+    OS_ASSERT( p_mbox != NULL );
+
+    if( p_mbox->head == p_mbox->tail )
+    {
+        return NULL;
+    }
+    OS_MEMORY_BARRIER();
+
+    p_slot = OS_MBOX_SLOT( p_mbox, p_mbox->head );
+    if( p_len )
+    {
+        *p_len = *(os_uint16_t *)p_slot;
+    }
+    return p_slot + OS_MBOX_SLOT_HDR;
+}
+
+/* hands the slot os_mbox_recv() returned back to the sender, task context only */
+void os_mbox_release( os_uint8_t task_id )
+{
+    OS_MBOX_t *p_mbox;
+
+    OS_ASSERT( task_id < os_task_max );
+    p_mbox = os_task_list[task_id].p_mbox;
+    OS_ASSERT( p_mbox != NULL && p_mbox->head != p_mbox->tail );
+
+    /* done reading the slot before it is handed back */
+    OS_MEMORY_BARRIER();
+    p_mbox->head++;
+
+    if( os_task_tcb[task_id].event == 0 && p_mbox->head == p_mbox->tail )
+    {
+        __os_task_ready_clr( task_id );
+    }
+}
+
+/* slots full now and sends refused as full so far, OS_ERR_EMPTY for a task without a mailbox */
+os_err_t os_mbox_stat_get( os_uint8_t task_id, os_uint8_t *p_count, os_uint16_t *p_drop )
+{
+    OS_MBOX_t *p_mbox;
+
+    OS_ASSERT( p_count != NULL && p_drop != NULL );
+
+    if( task_id >= os_task_max || os_task_list[task_id].p_mbox == NULL )
+    {
+        return OS_ERR_EMPTY;
+    }
+    p_mbox = os_task_list[task_id].p_mbox;
+    *p_count = (os_uint8_t)( p_mbox->tail - p_mbox->head );
+    *p_drop = p_mbox->drop;
+
+    return OS_ERR_NONE;
+}
+
+/* Private function implementations ------------------------------------------*/
+/* TRUE when os_mbox_recv() would return a slot */
+os_uint8_t __os_mbox_pending( os_uint8_t task_id )
+{
+    OS_MBOX_t *p_mbox = os_task_list[task_id].p_mbox;
+
+    return p_mbox != NULL && p_mbox->head != p_mbox->tail;
+}
+
+#endif //OS_MBOX_EN
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
@@ -16,15 +16,69 @@
 
 /* Exported variables --------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
+#ifdef OS_MSG_POOL_EN
+/* block of a class in words, keeps every block word aligned */
+#define OS_MSG_POOL_BLOCK(size)     ( ( sizeof(OS_MSG_t) + (size) + 3 ) / 4 )
+#define OS_MSG_POOL_WORDS           ( OS_MSG_POOL_8   * OS_MSG_POOL_BLOCK(8)  + \
+                                      OS_MSG_POOL_16  * OS_MSG_POOL_BLOCK(16) + \
+                                      OS_MSG_POOL_32  * OS_MSG_POOL_BLOCK(32) + \
+                                      OS_MSG_POOL_64  * OS_MSG_POOL_BLOCK(64) + \
+                                      OS_MSG_POOL_128 * OS_MSG_POOL_BLOCK(128) )
+#endif
+
 /* Private typedef -----------------------------------------------------------*/
+#ifdef OS_MSG_POOL_EN
+typedef struct os_msg_pool_ctrl {
+    OS_MSG_t *p_free;                       // free blocks, linked through OS_MSG_t.next
+    os_uint32_t *p_start;
+    os_uint32_t *p_end;
+    os_uint16_t used;
+    os_uint16_t used_max;
+    os_uint16_t miss;
+} OS_MSG_POOL_CTRL_t;
+#endif
+
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 extern const OS_TASK_t *os_task_list;
 extern OS_TCB_t *os_task_tcb;
 extern const os_uint8_t os_task_max;
 
+#ifdef OS_MSG_POOL_EN
+static const os_uint16_t os_msg_pool_size[OS_MSG_POOL_CLASS_MAX] = { 8, 16, 32, 64, 128 };
+static const os_uint16_t os_msg_pool_count[OS_MSG_POOL_CLASS_MAX] = {
+    OS_MSG_POOL_8, OS_MSG_POOL_16, OS_MSG_POOL_32, OS_MSG_POOL_64, OS_MSG_POOL_128
+};
+static os_uint32_t os_msg_pool_mem[OS_MSG_POOL_WORDS + 1];
+static OS_MSG_POOL_CTRL_t os_msg_pool[OS_MSG_POOL_CLASS_MAX];
+#endif
+
+#ifdef OS_MSG_MULTICAST_EN
+static OS_MSG_REF_t os_msg_ref_pool[OS_MSG_REF_MAX];
+static OS_MSG_REF_t *os_msg_ref_free;       // linked through node.next
+#endif
+
 
 /* Private function prototypes -----------------------------------------------*/
+extern void __os_task_ready_set( os_uint8_t task_id );
+extern void __os_task_ready_clr( os_uint8_t task_id );
+void __os_msg_init( void );
+os_uint8_t __os_msg_pending( os_uint8_t task_id );
+static os_uint8_t os_msg_depth( os_uint8_t task_id );
+static os_err_t os_msg_reserve( os_uint8_t task_id );
+static void os_msg_enqueue( os_uint8_t task_id, os_uint8_t prio, OS_MSG_t *pnode );
+static OS_MSG_t *os_msg_take( os_uint8_t task_id );
+static void *os_msg_payload( os_uint8_t task_id, OS_MSG_t *pnode );
+static void os_msg_queue_init( OS_MSG_QUEUE_t *pq );
+static void os_msg_queue_push( OS_MSG_QUEUE_t *pq, OS_MSG_t *pnode );
+static OS_MSG_t *os_msg_queue_pop( OS_MSG_QUEUE_t *pq );
+static os_uint8_t os_msg_queue_ready( OS_MSG_QUEUE_t *pq );
+#ifdef OS_MSG_POOL_EN
+static void os_msg_pool_init( void );
+#endif
+static OS_MSG_t *os_msg_alloc( os_uint16_t len );
+static void os_msg_free( OS_MSG_t *pnode );
+
 /* Exported function implementations -----------------------------------------*/
 void *os_msg_create ( os_uint16_t len, os_int8_t type )
 {
@@ -33,86 +87,248 @@ void *os_msg_create ( os_uint16_t len, os_int8_t type )
 
     OS_ASSERT( len > 0 );
     
-    pnode_new = (OS_MSG_t *)os_mem_alloc( sizeof(OS_MSG_t) + len );
+    pnode_new = os_msg_alloc( len );
     if( pnode_new )
     {
+        OS_TRACE( OS_TRACE_ALLOC, os_get_task_id_self(), sizeof(OS_MSG_t) + len );
         pmsg = (void *)( (os_uint8_t *)pnode_new + sizeof( OS_MSG_t ) );
         pnode_new->len = len;
         pnode_new->type = type;
         pnode_new->next = NULL;
+#ifdef OS_MSG_MULTICAST_EN
+        pnode_new->refs = 0;
+#endif
     }
 
     return pmsg;
 }
 
+/* a multicast message is freed by the delete of its last receiver */
 void os_msg_delete ( void *pmsg )
 {
+    OS_MSG_t *pnode;
+#ifdef OS_MSG_MULTICAST_EN
+    os_uint8_t refs;
+#endif
+
     OS_ASSERT( pmsg != NULL ); // should be in the range of theHeap start address and end address
-    os_mem_free( (os_uint8_t *)pmsg - sizeof(OS_MSG_t) );
+    pnode = (OS_MSG_t *)( (os_uint8_t *)pmsg - sizeof(OS_MSG_t) );
+#ifdef OS_MSG_MULTICAST_EN
+    if( pnode->refs )
+    {
+        OS_ENTER_CRITICAL();
+        refs = --pnode->refs;
+        OS_EXIT_CRITICAL();
+        if( refs )
+        {
+            return;
+        }
+    }
+#endif
+    OS_TRACE( OS_TRACE_FREE, os_get_task_id_self(), sizeof(OS_MSG_t) + pnode->len );
+    os_msg_free( pnode );
 }
 
-void os_msg_send ( void *pmsg, os_uint8_t task_id )
+/*
+ * Queues the message at level prio, level 0 is received first and messages
+ * of one level keep their order. Returns OS_ERR_FULL when the task already
+ * has its msg_depth queued, the message then still belongs to the caller.
+ * Safe from interrupts, nothing is masked on targets with exclusive access.
+ */
+os_err_t os_msg_send_prio( void *pmsg, os_uint8_t task_id, os_uint8_t prio )
 {
     OS_MSG_t *pnode;
 
     OS_ASSERT( pmsg != NULL ); // should be in the range of theHeap start address and end address
     OS_ASSERT( task_id < os_task_max );
     OS_ASSERT( os_task_list[task_id].p_task_handler != NULL );
+    OS_ASSERT( prio < OS_MSG_PRIO_MAX );
     
+    if( os_msg_reserve( task_id ) != OS_ERR_NONE )
+    {
+        return OS_ERR_FULL;
+    }
+
     pnode = (OS_MSG_t *)((os_uint8_t *)pmsg - sizeof(OS_MSG_t));
     pnode->from_task_id = os_get_task_id_self();
+    OS_TRACE( OS_TRACE_MSG_SEND, task_id, pnode->len );
 
-    if( os_task_tcb[task_id].ptail )
-    {
-        os_task_tcb[task_id].ptail->next = pnode;
-    }
-    else
-    {
-        os_task_tcb[task_id].phead = pnode;
-    }
-    os_task_tcb[task_id].ptail = pnode;
+    os_msg_enqueue( task_id, prio, pnode );
+    return OS_ERR_NONE;
+}
+
+os_err_t os_msg_send ( void *pmsg, os_uint8_t task_id )
+{
+    return os_msg_send_prio( pmsg, task_id, OS_MSG_PRIO_NORMAL );
 }
 
-void os_msg_send_urgent ( void *pmsg, os_uint8_t task_id )
+/* received ahead of every os_msg_send() message, urgent ones keep their own order */
+os_err_t os_msg_send_urgent ( void *pmsg, os_uint8_t task_id )
+{
+    return os_msg_send_prio( pmsg, task_id, OS_MSG_PRIO_URGENT );
+}
+
+#ifdef OS_MSG_MULTICAST_EN
+/*
+ * Queues one message for count tasks at the normal level without copying
+ * it, a task id may be given more than once. Every receiver os_msg_delete()s
+ * it as usual. Sends nothing and returns OS_ERR_FULL when a receiver has no
+ * room or fewer than count reference nodes are left, the message then still
+ * belongs to the caller. Safe from interrupts.
+ */
+os_err_t os_msg_send_multi( void *pmsg, const os_uint8_t *p_task_id, os_uint8_t count )
 {
     OS_MSG_t *pnode;
+    OS_MSG_REF_t *pref;
+    OS_MSG_REF_t *plist;
+    os_uint8_t i;
 
     OS_ASSERT( pmsg != NULL ); // should be in the range of theHeap start address and end address
-    OS_ASSERT( task_id < os_task_max );
-    OS_ASSERT( os_task_list[task_id].p_task_handler != NULL );
+    OS_ASSERT( p_task_id != NULL && count > 0 );
     
     pnode = (OS_MSG_t *)((os_uint8_t *)pmsg - sizeof(OS_MSG_t));
-    pnode->from_task_id = os_get_task_id_self();
+    OS_ASSERT( pnode->refs == 0 );
 
-    if( os_task_tcb[task_id].phead )
+    /* reserve everything first, a partial delivery could not be undone */
+    for( i = 0; i < count; i++ )
     {
-        pnode->next = os_task_tcb[task_id].phead;
+        OS_ASSERT( p_task_id[i] < os_task_max );
+        OS_ASSERT( os_task_list[p_task_id[i]].p_task_handler != NULL );
+        if( os_msg_reserve( p_task_id[i] ) != OS_ERR_NONE )
+        {
+            break;
+        }
     }
-    else
+
+    OS_ENTER_CRITICAL();
+    plist = os_msg_ref_free;
+    if( i == count )
     {
-        os_task_tcb[task_id].ptail = pnode;
+        for( i = 0, pref = plist; i < count && pref; i++ )
+        {
+            pref = (OS_MSG_REF_t *)pref->node.next;
+        }
+        if( i == count )
+        {
+            os_msg_ref_free = pref;
+        }
+    }
+    OS_EXIT_CRITICAL();
+
+    if( i < count )
+    {
+        while( i-- )
+        {
+            OS_ATOMIC_FETCH_SUB( &os_task_tcb[p_task_id[i]].msg_cnt, 1 );
+        }
+        return OS_ERR_FULL;
     }
-    os_task_tcb[task_id].phead = pnode;
-}
 
+    pnode->from_task_id = os_get_task_id_self();
+    pnode->refs = count;
+    for( i = 0; i < count; i++ )
+    {
+        OS_TRACE( OS_TRACE_MSG_SEND, p_task_id[i], pnode->len );
+
+        pref = plist;
+        plist = (OS_MSG_REF_t *)pref->node.next;
+        pref->pshared = pnode;
+        os_msg_enqueue( p_task_id[i], OS_MSG_PRIO_NORMAL, &pref->node );
+    }
 
+    return OS_ERR_NONE;
+}
+#endif
+
+/* only the task itself may receive, task context only */
 void *os_msg_recv( os_uint8_t task_id )
 {
-    void *pmsg = NULL;
+    OS_MSG_t *pnode;
 
     OS_ASSERT( task_id < os_task_max );
     
-    if( os_task_tcb[task_id].phead != NULL )
+#ifdef OS_CO_EN
+    os_task_tcb[task_id].msg_hold = FALSE;
+#endif
+    pnode = os_msg_take( task_id );
+    if( pnode == NULL )
+    {
+        return NULL;
+    }
+
+    if( os_task_tcb[task_id].event == 0 && !__os_msg_pending( task_id ) )
+    {
+        __os_task_ready_clr( task_id );
+    }
+    
+    return os_msg_payload( task_id, pnode );
+}
+
+/*
+ * Takes every message queued for the task in one call, in the order
+ * os_msg_recv() would return them, and returns how many. Walk the list with
+ * os_msg_list_pop() before the handler returns, messages sent meanwhile wait
+ * for the next call. Only the task itself may receive, task context only.
+ */
+os_uint8_t os_msg_recv_all( os_uint8_t task_id, OS_MSG_LIST_t *p_list )
+{
+    OS_MSG_t *pnode;
+    OS_MSG_t *ptail = NULL;
+    os_uint8_t cnt;
+    os_uint8_t i;
+
+    OS_ASSERT( task_id < os_task_max );
+    OS_ASSERT( p_list != NULL );
+
+#ifdef OS_CO_EN
+    os_task_tcb[task_id].msg_hold = FALSE;
+#endif
+    /* no more than were queued on entry, interrupts could keep it going */
+    cnt = os_task_tcb[task_id].msg_cnt;
+    p_list->phead = NULL;
+    for( i = 0; i < cnt; i++ )
     {
-        pmsg = (void *)((os_uint8_t *)os_task_tcb[task_id].phead + sizeof(OS_MSG_t));
-        os_task_tcb[task_id].phead = os_task_tcb[task_id].phead->next;
-        if( os_task_tcb[task_id].phead == NULL )
+        pnode = os_msg_take( task_id );
+        if( pnode == NULL )
+        {
+            break;
+        }
+        pnode->next = NULL;
+        if( ptail )
         {
-            os_task_tcb[task_id].ptail = NULL;
+            ptail->next = pnode;
         }
+        else
+        {
+            p_list->phead = pnode;
+        }
+        ptail = pnode;
     }
-    
-    return pmsg;
+    p_list->task_id = task_id;
+
+    if( os_task_tcb[task_id].event == 0 && !__os_msg_pending( task_id ) )
+    {
+        __os_task_ready_clr( task_id );
+    }
+
+    return i;
+}
+
+/* next message of an os_msg_recv_all() list, NULL at its end */
+void *os_msg_list_pop( OS_MSG_LIST_t *p_list )
+{
+    OS_MSG_t *pnode;
+
+    OS_ASSERT( p_list != NULL );
+
+    pnode = p_list->phead;
+    if( pnode == NULL )
+    {
+        return NULL;
+    }
+    p_list->phead = pnode->next;
+
+    return os_msg_payload( p_list->task_id, pnode );
 }
 
 os_uint16_t os_msg_len ( void *pmsg )
@@ -133,8 +349,382 @@ os_uint8_t os_msg_from ( void *pmsg )
     return ((OS_MSG_t *)((os_uint8_t *)pmsg - sizeof(OS_MSG_t)))->from_task_id;
 }
 
+/* queue counters of a task, returns OS_ERR_EMPTY past the last task */
+os_err_t os_msg_stat_get( os_uint8_t task_id, OS_MSG_STAT_t *p_stat )
+{
+    OS_ASSERT( p_stat != NULL );
+
+    if( task_id >= os_task_max )
+    {
+        return OS_ERR_EMPTY;
+    }
+
+    p_stat->depth = os_msg_depth( task_id );
+    OS_ENTER_CRITICAL();
+    p_stat->count = os_task_tcb[task_id].msg_cnt;
+    p_stat->count_max = os_task_tcb[task_id].msg_cnt_max;
+    p_stat->drop = os_task_tcb[task_id].msg_drop;
+    OS_EXIT_CRITICAL();
+
+    return OS_ERR_NONE;
+}
+
+#ifdef OS_MSG_POOL_EN
+/* size class index 0 is the smallest, returns OS_ERR_EMPTY past the largest */
+os_err_t os_msg_pool_get( os_uint8_t index, OS_MSG_POOL_t *p_pool )
+{
+    OS_ASSERT( p_pool != NULL );
+
+    if( index >= OS_MSG_POOL_CLASS_MAX )
+    {
+        return OS_ERR_EMPTY;
+    }
+
+    p_pool->size = os_msg_pool_size[index];
+    p_pool->count = os_msg_pool_count[index];
+    OS_ENTER_CRITICAL();
+    p_pool->used = os_msg_pool[index].used;
+    p_pool->used_max = os_msg_pool[index].used_max;
+    p_pool->miss = os_msg_pool[index].miss;
+    OS_EXIT_CRITICAL();
+
+    return OS_ERR_NONE;
+}
+#endif
 
 /* Private function implementations ------------------------------------------*/
+/* before any interrupt may send */
+void __os_msg_init( void )
+{
+    os_uint8_t task_id;
+    os_uint8_t prio;
+#ifdef OS_MSG_MULTICAST_EN
+    os_uint16_t i;
+#endif
+
+    for( task_id = 0; task_id < os_task_max; task_id++ )
+    {
+        for( prio = 0; prio < OS_MSG_PRIO_MAX; prio++ )
+        {
+            os_msg_queue_init( &os_task_tcb[task_id].msgq[prio] );
+        }
+        os_task_tcb[task_id].msg_map = 0;
+        os_task_tcb[task_id].msg_cnt = 0;
+#ifdef OS_CO_EN
+        os_task_tcb[task_id].msg_hold = FALSE;
+#endif
+    }
+#ifdef OS_MSG_MULTICAST_EN
+    os_msg_ref_free = NULL;
+    for( i = 0; i < OS_MSG_REF_MAX; i++ )
+    {
+        os_msg_ref_pool[i].node.next = (OS_MSG_t *)os_msg_ref_free;
+        os_msg_ref_free = &os_msg_ref_pool[i];
+    }
+#endif
+#ifdef OS_MSG_POOL_EN
+    os_msg_pool_init();
+#endif
+}
+
+/*
+ * TRUE when os_msg_recv() would return a message and the task is to be
+ * called for it. A message whose sender was interrupted between the swap and
+ * the link does not count yet, that sender sets the ready bit again once it
+ * has linked the node. Nor do messages held back from a coroutine that took
+ * none when it was last called for one.
+ */
+os_uint8_t __os_msg_pending( os_uint8_t task_id )
+{
+    os_uint8_t map;
+
+#ifdef OS_CO_EN
+    if( os_task_tcb[task_id].msg_hold )
+    {
+        return FALSE;
+    }
+#endif
+
+    for( map = os_task_tcb[task_id].msg_map; map; map &= map - 1 )
+    {
+        if( os_msg_queue_ready( &os_task_tcb[task_id].msgq[OS_CTZ32( map )] ) )
+        {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static os_uint8_t os_msg_depth( os_uint8_t task_id )
+{
+    return os_task_list[task_id].msg_depth ? os_task_list[task_id].msg_depth : OS_MSG_DEPTH;
+}
+
+/*
+ * Counts one more message against the depth of the task, OS_ERR_FULL and a
+ * drop counted when it has no room. The high-water mark may miss a sender
+ * that interrupts another one, it is a statistic only.
+ */
+static os_err_t os_msg_reserve( os_uint8_t task_id )
+{
+    OS_TCB_t *ptcb = &os_task_tcb[task_id];
+    os_uint8_t depth = os_msg_depth( task_id );
+    os_uint8_t cnt;
+
+    if( ptcb->msg_cnt < depth )
+    {
+        cnt = (os_uint8_t)( OS_ATOMIC_FETCH_ADD( &ptcb->msg_cnt, 1 ) + 1 );
+        if( cnt <= depth )
+        {
+            if( cnt > ptcb->msg_cnt_max )
+            {
+                ptcb->msg_cnt_max = cnt;
+            }
+            return OS_ERR_NONE;
+        }
+        OS_ATOMIC_FETCH_SUB( &ptcb->msg_cnt, 1 );
+    }
+
+    OS_ATOMIC_FETCH_ADD( &ptcb->msg_drop, 1 );
+    return OS_ERR_FULL;
+}
+
+/* the level bit goes up after the link, a receiver that misses it gets the message later */
+static void os_msg_enqueue( os_uint8_t task_id, os_uint8_t prio, OS_MSG_t *pnode )
+{
+    os_msg_queue_push( &os_task_tcb[task_id].msgq[prio], pnode );
+    OS_ATOMIC_FETCH_OR( &os_task_tcb[task_id].msg_map, BV( prio ) );
+    __os_task_ready_set( task_id );
+}
+
+/* next node of the highest level, a multicast one still as its reference */
+static OS_MSG_t *os_msg_take( os_uint8_t task_id )
+{
+    OS_TCB_t *ptcb = &os_task_tcb[task_id];
+    OS_MSG_t *pnode = NULL;
+    os_uint8_t map;
+    os_uint8_t prio;
+
+    for( map = ptcb->msg_map; map; map &= map - 1 )
+    {
+        prio = OS_CTZ32( map );
+        pnode = os_msg_queue_pop( &ptcb->msgq[prio] );
+        if( pnode )
+        {
+            break;
+        }
+
+        /* a level drained, a sender still linking into it sets the bit again */
+        OS_ATOMIC_FETCH_AND( &ptcb->msg_map, (os_uint8_t)~BV( prio ) );
+        if( os_msg_queue_ready( &ptcb->msgq[prio] ) )
+        {
+            OS_ATOMIC_FETCH_OR( &ptcb->msg_map, BV( prio ) );
+            pnode = os_msg_queue_pop( &ptcb->msgq[prio] );
+            break;
+        }
+    }
+
+    if( pnode )
+    {
+        OS_ATOMIC_FETCH_SUB( &ptcb->msg_cnt, 1 );
+    }
+    return pnode;
+}
+
+/* what the task gets for a taken node, a reference node goes back to its pool */
+static void *os_msg_payload( os_uint8_t task_id, OS_MSG_t *pnode )
+{
+#ifdef OS_MSG_MULTICAST_EN
+    OS_MSG_REF_t *pref;
+
+    if( (OS_MSG_REF_t *)pnode >= os_msg_ref_pool && (OS_MSG_REF_t *)pnode < os_msg_ref_pool + OS_MSG_REF_MAX )
+    {
+        pref = (OS_MSG_REF_t *)pnode;
+        pnode = pref->pshared;
+        OS_ENTER_CRITICAL();
+        pref->node.next = (OS_MSG_t *)os_msg_ref_free;
+        os_msg_ref_free = pref;
+        OS_EXIT_CRITICAL();
+    }
+#endif
+
+    OS_TRACE( OS_TRACE_MSG_RECV, task_id, pnode->len );
+    (void)task_id;
+    return (void *)((os_uint8_t *)pnode + sizeof(OS_MSG_t));
+}
+
+static void os_msg_queue_init( OS_MSG_QUEUE_t *pq )
+{
+    pq->stub.next = NULL;
+    pq->phead = &pq->stub;
+    pq->ptail = &pq->stub;
+}
+
+/* wait free, one exchange then a plain store */
+static void os_msg_queue_push( OS_MSG_QUEUE_t *pq, OS_MSG_t *pnode )
+{
+    OS_MSG_t *pprev;
+
+    pnode->next = NULL;
+    pprev = OS_ATOMIC_XCHG_PTR( &pq->ptail, pnode );
+    pprev->next = pnode;
+}
+
+/*
+ * Owner task only. The last node is not taken while it is still ptail, the
+ * stub is pushed behind it first so that a node always stays queued.
+ */
+static OS_MSG_t *os_msg_queue_pop( OS_MSG_QUEUE_t *pq )
+{
+    OS_MSG_t *phead = pq->phead;
+    OS_MSG_t *pnext = phead->next;
+
+    if( phead == &pq->stub )
+    {
+        if( pnext == NULL )
+        {
+            return NULL;
+        }
+        pq->phead = pnext;
+        phead = pnext;
+        pnext = pnext->next;
+    }
+
+    if( pnext == NULL )
+    {
+        if( phead != pq->ptail )
+        {
+            return NULL;                    // a sender is between its swap and its link
+        }
+        os_msg_queue_push( pq, &pq->stub );
+        pnext = phead->next;
+        if( pnext == NULL )
+        {
+            return NULL;                    // a sender swapped in ahead of the stub
+        }
+    }
+
+    pq->phead = pnext;
+    return phead;
+}
+
+static os_uint8_t os_msg_queue_ready( OS_MSG_QUEUE_t *pq )
+{
+    OS_MSG_t *phead = pq->phead;
+
+    if( phead == &pq->stub )
+    {
+        phead = phead->next;
+        if( phead == NULL )
+        {
+            return FALSE;
+        }
+    }
+
+    return phead->next != NULL || phead == pq->ptail;
+}
+
+#ifdef OS_MSG_POOL_EN
+static void os_msg_pool_init( void )
+{
+    os_uint32_t *p_block = os_msg_pool_mem;
+    os_uint8_t cls;
+    os_uint16_t i;
+
+    for( cls = 0; cls < OS_MSG_POOL_CLASS_MAX; cls++ )
+    {
+        os_msg_pool[cls].p_free = NULL;
+        os_msg_pool[cls].p_start = p_block;
+        for( i = 0; i < os_msg_pool_count[cls]; i++ )
+        {
+            ((OS_MSG_t *)p_block)->next = os_msg_pool[cls].p_free;
+            os_msg_pool[cls].p_free = (OS_MSG_t *)p_block;
+            p_block += OS_MSG_POOL_BLOCK( os_msg_pool_size[cls] );
+        }
+        os_msg_pool[cls].p_end = p_block;
+        os_msg_pool[cls].used = 0;
+        os_msg_pool[cls].used_max = 0;
+        os_msg_pool[cls].miss = 0;
+    }
+}
+#endif
+
+/*
+ * Takes a block from the smallest class that fits and has one left, each
+ * pool is a free-list stack popped with interrupts masked. Classes given no
+ * blocks are skipped, messages larger than the largest configured class
+ * come from the heap.
+ */
+static OS_MSG_t *os_msg_alloc( os_uint16_t len )
+{
+#ifdef OS_MSG_POOL_EN
+    OS_MSG_t *pnode = NULL;
+    os_uint8_t cls;
+    os_uint8_t fit;
+
+    for( fit = 0; fit < OS_MSG_POOL_CLASS_MAX; fit++ )
+    {
+        if( os_msg_pool_count[fit] && len <= os_msg_pool_size[fit] )
+            break;
+    }
+
+    if( fit < OS_MSG_POOL_CLASS_MAX )
+    {
+        OS_ENTER_CRITICAL();
+        for( cls = fit; cls < OS_MSG_POOL_CLASS_MAX; cls++ )
+        {
+            if( os_msg_pool_count[cls] == 0 )
+                continue;
+            pnode = os_msg_pool[cls].p_free;
+            if( pnode )
+            {
+                os_msg_pool[cls].p_free = pnode->next;
+                if( ++os_msg_pool[cls].used > os_msg_pool[cls].used_max )
+                {
+                    os_msg_pool[cls].used_max = os_msg_pool[cls].used;
+                }
+                break;
+            }
+            os_msg_pool[cls].miss++;
+        }
+        OS_EXIT_CRITICAL();
+        return pnode;
+    }
+#endif
+
+#ifdef OS_MEM_EN
+    return (OS_MSG_t *)os_mem_alloc( sizeof(OS_MSG_t) + len );
+#else
+    return NULL;
+#endif
+}
+
+static void os_msg_free( OS_MSG_t *pnode )
+{
+#ifdef OS_MSG_POOL_EN
+    os_uint8_t cls;
+
+    for( cls = 0; cls < OS_MSG_POOL_CLASS_MAX; cls++ )
+    {
+        if( (os_uint32_t *)pnode >= os_msg_pool[cls].p_start &&
+            (os_uint32_t *)pnode < os_msg_pool[cls].p_end )
+        {
+            OS_ENTER_CRITICAL();
+            pnode->next = os_msg_pool[cls].p_free;
+            os_msg_pool[cls].p_free = pnode;
+            os_msg_pool[cls].used--;
+            OS_EXIT_CRITICAL();
+            return;
+        }
+    }
+#endif
+
+#ifdef OS_MEM_EN
+    os_mem_free( pnode );
+#else
+    OS_ASSERT_FORCED();
+#endif
+}
 
 
 #endif //OS_MSG_EN
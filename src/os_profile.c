@@ -0,0 +1,119 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/* Includes ------------------------------------------------------------------*/
+#include "os.h"
+
+#ifdef OS_PROFILE_EN
+
+/* Exported variables --------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define OS_PROFILE_SLOT_MASK    (OS_PROFILE_SLOT_MAX - 1)
+
+#if (OS_PROFILE_SLOT_MAX & OS_PROFILE_SLOT_MASK) || (OS_PROFILE_SLOT_MAX > 256)
+#error "OS_PROFILE_SLOT_MAX should be a power of 2 and not larger than 256."
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* (task_id, event_id) hashed into the table, OS_TASK_EVT_MSG is -1 and OS_TASK_EVT_MBOX -2 */
+#define OS_PROFILE_HASH(t,e)    ((os_uint8_t)((t) * 33 + (e) + 1) & OS_PROFILE_SLOT_MASK)
+
+/* Private variables ---------------------------------------------------------*/
+static OS_PROFILE_t os_profile_tbl[OS_PROFILE_SLOT_MAX];
+static os_uint32_t os_profile_missed;
+
+/* Private function prototypes -----------------------------------------------*/
+void __os_profile_record( os_uint8_t task_id, os_int8_t event_id, os_uint32_t cycles );
+
+/* Exported function implementations -----------------------------------------*/
+void os_profile_reset( void )
+{
+    os_memset( os_profile_tbl, 0, sizeof(os_profile_tbl) );
+    os_profile_missed = 0;
+}
+
+/* returns OS_ERR_EMPTY for an unused slot, OS_ERR_INVAL past the table */
+os_err_t os_profile_get( os_uint8_t index, OS_PROFILE_t *p_profile )
+{
+    OS_ASSERT( p_profile != NULL );
+
+    if( index >= OS_PROFILE_SLOT_MAX )
+        return OS_ERR_INVAL;
+
+    if( os_profile_tbl[index].count == 0 )
+        return OS_ERR_EMPTY;
+
+    *p_profile = os_profile_tbl[index];
+    return OS_ERR_NONE;
+}
+
+/* handler calls that found the table full */
+os_uint32_t os_profile_missed_get( void )
+{
+    return os_profile_missed;
+}
+
+/* Private function implementations ------------------------------------------*/
+void __os_profile_record( os_uint8_t task_id, os_int8_t event_id, os_uint32_t cycles )
+{
+    OS_PROFILE_t *p_profile;
+    os_uint8_t index;
+    os_uint8_t probe;
+    os_uint8_t bin;
+
+    index = OS_PROFILE_HASH( task_id, event_id );
+    for( probe = 0; probe < OS_PROFILE_SLOT_MAX; probe++ )
+    {
+        p_profile = &os_profile_tbl[index];
+        if( p_profile->count == 0 )
+        {
+            p_profile->task_id = task_id;
+            p_profile->event_id = event_id;
+            p_profile->min = UINT32_MAX;
+            break;
+        }
+        if( p_profile->task_id == task_id && p_profile->event_id == event_id )
+        {
+            break;
+        }
+        index = ( index + 1 ) & OS_PROFILE_SLOT_MASK;
+    }
+
+    if( probe == OS_PROFILE_SLOT_MAX )
+    {
+        os_profile_missed++;
+        return;
+    }
+
+    /* a full count stops the sum with it, the mean stays true */
+    if( p_profile->count != UINT32_MAX )
+    {
+        p_profile->sum += cycles;
+        p_profile->count++;
+    }
+
+    if( cycles < p_profile->min )
+        p_profile->min = cycles;
+    if( cycles > p_profile->max )
+        p_profile->max = cycles;
+
+    /* bin n holds [2^(n+shift), 2^(n+shift+1)), both ends are open */
+    cycles >>= OS_PROFILE_HIST_SHIFT;
+    bin = cycles ? (os_uint8_t)( 31 - OS_CLZ32( cycles ) ) : 0;
+    if( bin >= OS_PROFILE_HIST_MAX )
+        bin = OS_PROFILE_HIST_MAX - 1;
+    if( p_profile->hist[bin] < UINT16_MAX )
+        p_profile->hist[bin]++;
+}
+
+#endif //OS_PROFILE_EN
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
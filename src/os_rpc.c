@@ -0,0 +1,290 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/*
+ * Request/response between tasks. os_rpc_call() sends the request as a plain
+ * message and keeps the call in a fixed table under a correlation id. The
+ * server answers with os_rpc_reply() before it deletes the request. Either
+ * way the caller gets the event it named, posted with the id as argument,
+ * and collects the reply or the timeout with os_rpc_result(). All pending
+ * calls share one deadline, the nearest, checked once per scheduler pass.
+ *
+ *  void client_task( os_int8_t event_id )
+ *  {
+ *      void *p_rsp;
+ *
+ *      switch( event_id )
+ *      {
+ *      case CLIENT_EVT_READ:
+ *          p_req = os_msg_create( sizeof(i2c_read_t), 0 );
+ *          ...
+ *          if( os_rpc_call( i2c_task_id, p_req, 100, CLIENT_EVT_REPLY ) == 0 )
+ *              os_msg_delete( p_req );
+ *          break;
+ *      case CLIENT_EVT_REPLY:
+ *          if( os_rpc_result( (os_uint16_t)os_task_event_arg(), &p_rsp ) == OS_ERR_NONE )
+ *          {
+ *              ...
+ *              os_msg_delete( p_rsp );
+ *          }
+ *          break;
+ *      }
+ *  }
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "os.h"
+
+#ifdef OS_RPC_EN
+
+/* Exported variables --------------------------------------------------------*/
+extern const OS_TASK_t *os_task_list;
+extern volatile os_uint32_t os_systick;
+
+/* Private define ------------------------------------------------------------*/
+#define OS_RPC_FREE             0
+#define OS_RPC_WAIT             1           // the server holds the request
+#define OS_RPC_DONE             2           // answered or timed out, the post is still to go
+#define OS_RPC_POSTED           3           // the caller has its event, os_rpc_result() is due
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct os_rpc {
+    void *preq;                             // request while OS_RPC_WAIT
+    void *prsp;                             // reply, NULL after a timeout
+    os_uint32_t deadline;                   // os_systick
+    os_uint16_t id;
+    os_uint8_t task_id;                     // caller
+    os_int8_t event_id;
+    os_uint8_t state;
+    os_err_t err;
+} OS_RPC_t;
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static OS_RPC_t os_rpc_table[OS_RPC_MAX];
+static os_uint16_t os_rpc_id;               // last correlation id handed out
+static os_uint32_t os_rpc_deadline;         // nearest deadline of the waiting calls
+static os_uint8_t os_rpc_wait;              // calls in OS_RPC_WAIT
+static os_uint8_t os_rpc_done;              // calls in OS_RPC_DONE
+
+/* Private function prototypes -----------------------------------------------*/
+void __os_rpc_process( void );
+os_uint32_t __os_rpc_next( void );
+static void os_rpc_finish( OS_RPC_t *p_rpc, void *prsp, os_err_t err );
+static void os_rpc_post( void );
+
+/* Exported function implementations -----------------------------------------*/
+/*
+ * Sends preq to the task and returns the correlation id the reply comes
+ * with. event_id is posted to the calling task, which needs post slots, once
+ * the reply is there or timeout ticks have passed. Returns 0 when the table
+ * or the server queue is full, the request then still belongs to the caller.
+ * Task context only.
+ */
+os_uint16_t os_rpc_call( os_uint8_t task_id, void *preq, os_uint32_t timeout, os_int8_t event_id )
+{
+    OS_RPC_t *p_rpc = NULL;
+    os_uint8_t i;
+
+    OS_ASSERT( preq != NULL && timeout != 0 && timeout < 0x80000000uL );
+    OS_ASSERT( event_id >= 0 && event_id < OS_TASK_EVENT_MAX );
+    OS_ASSERT( os_task_list[os_get_task_id_self()].p_post != NULL );
+
+    OS_URGENT_LOCK();
+    for( i = 0; i < OS_RPC_MAX; i++ )
+    {
+        if( os_rpc_table[i].state == OS_RPC_FREE )
+        {
+            p_rpc = &os_rpc_table[i];
+            break;
+        }
+    }
+    if( p_rpc == NULL )
+    {
+        OS_URGENT_UNLOCK();
+        return 0;
+    }
+
+    if( ++os_rpc_id == 0 )
+    {
+        os_rpc_id = 1;
+    }
+    p_rpc->id = os_rpc_id;
+    p_rpc->preq = preq;
+    p_rpc->prsp = NULL;
+    p_rpc->deadline = os_systick + timeout;
+    p_rpc->task_id = os_get_task_id_self();
+    p_rpc->event_id = event_id;
+    p_rpc->state = OS_RPC_WAIT;
+    if( os_rpc_wait++ == 0 || (os_int32_t)( p_rpc->deadline - os_rpc_deadline ) < 0 )
+    {
+        os_rpc_deadline = p_rpc->deadline;
+    }
+    OS_URGENT_UNLOCK();
+
+    if( os_msg_send( preq, task_id ) != OS_ERR_NONE )
+    {
+        OS_URGENT_LOCK();
+        p_rpc->state = OS_RPC_FREE;
+        os_rpc_wait--;
+        OS_URGENT_UNLOCK();
+        return 0;
+    }
+
+    return p_rpc->id;
+}
+
+/*
+ * Answers the call that sent preq, to be called before preq is deleted.
+ * Takes prsp in any case, it may be NULL for a bare acknowledge. Returns
+ * OS_ERR_EMPTY and deletes prsp when the call has timed out or preq did not
+ * come from os_rpc_call(). Task context only.
+ */
+os_err_t os_rpc_reply( void *preq, void *prsp )
+{
+    os_uint8_t i;
+
+    OS_ASSERT( preq != NULL );
+
+    OS_URGENT_LOCK();
+    for( i = 0; i < OS_RPC_MAX; i++ )
+    {
+        if( os_rpc_table[i].state == OS_RPC_WAIT && os_rpc_table[i].preq == preq )
+        {
+            os_rpc_finish( &os_rpc_table[i], prsp, OS_ERR_NONE );
+            OS_URGENT_UNLOCK();
+            os_rpc_post();
+            return OS_ERR_NONE;
+        }
+    }
+    OS_URGENT_UNLOCK();
+
+    if( prsp )
+    {
+        os_msg_delete( prsp );
+    }
+    return OS_ERR_EMPTY;
+}
+
+/*
+ * Outcome of call id, asked from the event the call posted. Gives the reply
+ * with OS_ERR_NONE, the caller deletes it, or returns OS_ERR_TIMEOUT. Frees
+ * the table entry, a second call for the same id returns OS_ERR_EMPTY.
+ */
+os_err_t os_rpc_result( os_uint16_t id, void **pp_rsp )
+{
+    os_err_t err = OS_ERR_EMPTY;
+    os_uint8_t i;
+
+    OS_ASSERT( pp_rsp != NULL );
+
+    *pp_rsp = NULL;
+    OS_URGENT_LOCK();
+    for( i = 0; i < OS_RPC_MAX; i++ )
+    {
+        if( os_rpc_table[i].state == OS_RPC_POSTED && os_rpc_table[i].id == id )
+        {
+            *pp_rsp = os_rpc_table[i].prsp;
+            err = os_rpc_table[i].err;
+            os_rpc_table[i].state = OS_RPC_FREE;
+            break;
+        }
+    }
+    OS_URGENT_UNLOCK();
+
+    return err;
+}
+
+/* Private function implementations ------------------------------------------*/
+/* once per scheduler pass, times the waiting calls out against the one deadline */
+void __os_rpc_process( void )
+{
+    os_uint32_t now = os_systick;
+    os_uint8_t i;
+
+    if( os_rpc_wait && (os_int32_t)( now - os_rpc_deadline ) >= 0 )
+    {
+        OS_URGENT_LOCK();
+        for( i = 0; i < OS_RPC_MAX; i++ )
+        {
+            if( os_rpc_table[i].state == OS_RPC_WAIT && (os_int32_t)( now - os_rpc_table[i].deadline ) >= 0 )
+            {
+                os_rpc_finish( &os_rpc_table[i], NULL, OS_ERR_TIMEOUT );
+            }
+        }
+
+        /* a reply may have left the old nearest deadline behind, find the next one */
+        os_rpc_deadline = now + 0x7FFFFFFFuL;
+        for( i = 0; i < OS_RPC_MAX; i++ )
+        {
+            if( os_rpc_table[i].state == OS_RPC_WAIT &&
+                (os_int32_t)( os_rpc_table[i].deadline - os_rpc_deadline ) < 0 )
+            {
+                os_rpc_deadline = os_rpc_table[i].deadline;
+            }
+        }
+        OS_URGENT_UNLOCK();
+    }
+
+    /* posts that found the caller's slots full are retried, the caller is ready meanwhile */
+    if( os_rpc_done )
+    {
+        os_rpc_post();
+    }
+}
+
+#ifdef OS_TICKLESS_EN
+/* ticks until the nearest deadline, UINT32_MAX if no call waits */
+os_uint32_t __os_rpc_next( void )
+{
+    os_int32_t left;
+
+    if( os_rpc_wait == 0 )
+    {
+        return UINT32_MAX;
+    }
+
+    left = (os_int32_t)( os_rpc_deadline - os_systick );
+    return ( left > 0 ) ? (os_uint32_t)left : 1;
+}
+#endif
+
+/* called locked */
+static void os_rpc_finish( OS_RPC_t *p_rpc, void *prsp, os_err_t err )
+{
+    p_rpc->preq = NULL;
+    p_rpc->prsp = prsp;
+    p_rpc->err = err;
+    p_rpc->state = OS_RPC_DONE;
+    os_rpc_wait--;
+    os_rpc_done++;
+}
+
+static void os_rpc_post( void )
+{
+    os_uint8_t i;
+
+    OS_URGENT_LOCK();
+    for( i = 0; i < OS_RPC_MAX && os_rpc_done; i++ )
+    {
+        if( os_rpc_table[i].state == OS_RPC_DONE &&
+            os_task_post_event( os_rpc_table[i].task_id, os_rpc_table[i].event_id, os_rpc_table[i].id ) == OS_ERR_NONE )
+        {
+            os_rpc_table[i].state = OS_RPC_POSTED;
+            os_rpc_done--;
+        }
+    }
+    OS_URGENT_UNLOCK();
+}
+
+#endif /* OS_RPC_EN */
+
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
@@ -26,18 +26,87 @@ extern const os_uint8_t os_task_max;
 static os_event_t os_task_event;
 static os_uint8_t os_task_id;
 static os_int8_t os_event_id;
+#ifdef OS_POST_EN
+static os_uint32_t os_event_arg;
+#endif
+#ifdef OS_EVENT_COUNT_EN
+static os_uint8_t os_event_cnt[OS_TASK_EVENT_MAX];
+#endif
 
 /* Private function prototypes -----------------------------------------------*/
 #ifdef OS_MEM_EN
 #define __os_mem_init()     umm_init()
 #endif
+#ifdef OS_MSG_EN
+extern void __os_msg_init( void );
+extern os_uint8_t __os_msg_pending( os_uint8_t task_id );
+#endif
+#ifdef OS_MBOX_EN
+extern os_uint8_t __os_mbox_pending( os_uint8_t task_id );
+#endif
 #ifdef OS_CLOCK_EN
 extern void __os_clock_init( void );
-extern os_uint8_t __os_clock_update( void );
+extern os_uint32_t __os_clock_update( void );
 #endif
 #ifdef OS_TIMER_EN
 extern void __os_timer_init( void );
-extern void __os_timer_process( os_uint8_t delta_systick );
+extern void __os_timer_process( os_uint32_t delta_systick );
+#endif
+#ifdef OS_TICKLESS_EN
+extern void __os_clock_credit( os_uint32_t delta_systick );
+extern os_uint32_t __os_clock_pending( void );
+#ifdef OS_TIMER_EN
+extern os_uint32_t __os_timer_next( void );
+#endif
+static void os_sched_sleep( void );
+#endif
+static void os_sched_run( void );
+static void os_sched_dispatch( os_int8_t event_id );
+static void os_sched_call( os_int8_t event_id );
+#ifdef OS_EVENT_COUNT_EN
+static os_event_t os_sched_count( void );
+extern os_uint8_t __os_task_event_cnt_take( os_uint8_t task_id, os_int8_t event_id );
+#endif
+#ifdef OS_DEFER_EN
+extern void __os_defer_init( void );
+extern void __os_defer_process( void );
+extern os_uint8_t __os_defer_pending( void );
+#endif
+#ifdef OS_LOAD_EN
+extern void __os_load_init( void );
+extern void __os_load_update( void );
+extern void __os_load_idle_begin( void );
+extern void __os_load_idle_end( void );
+#endif
+#ifdef OS_RPC_EN
+extern void __os_rpc_process( void );
+#ifdef OS_TICKLESS_EN
+extern os_uint32_t __os_rpc_next( void );
+#endif
+#endif
+#ifdef OS_IDLE_EN
+extern os_uint8_t __os_idle_process( void );
+extern os_uint8_t __os_idle_pending( void );
+#endif
+#ifdef OS_PROFILE_EN
+extern void __os_profile_record( os_uint8_t task_id, os_int8_t event_id, os_uint32_t cycles );
+#endif
+#ifdef OS_BUDGET_EN
+extern void __os_budget_begin( os_uint8_t task_id, os_int8_t event_id );
+extern void __os_budget_end( void );
+#endif
+#if defined(OS_TICKLESS_EN) && defined(OS_INT_SAVE)
+extern void __os_critical_restart( void );
+#endif
+extern void __os_task_ready_clr( os_uint8_t task_id );
+extern os_uint8_t __os_task_ready_get( void );
+extern void __os_task_served( os_uint8_t task_id );
+#ifdef OS_URGENT_EN
+extern os_uint8_t __os_task_urgent_get( os_uint32_t skip );
+void __os_urgent_process( void );
+#endif
+#ifdef OS_POST_EN
+extern os_err_t __os_task_post_get( os_uint8_t task_id, os_int8_t *p_event_id, os_uint32_t *p_arg );
 #endif
 
 /* Exported function implementations -----------------------------------------*/
@@ -46,18 +115,86 @@ os_uint8_t os_get_task_id_self( void )
     return os_task_id;
 }
 
-int main( void )
+#ifdef OS_URGENT_EN
+/*
+ * The urgent level, called by the port from the software interrupt pended
+ * by OS_URGENT_PEND(). Runs each ready urgent task once, then puts back the
+ * dispatch state of the handler it preempted. A task left ready, say with a
+ * message it did not take, waits for the next entry, so the main level still
+ * gets to run and pends the level again.
+ */
+void __os_urgent_process( void )
 {
-    /* Disable Interrupts */
-    OS_ENTER_CRITICAL();
+    os_uint8_t task_id = os_task_id;
+    os_int8_t event_id = os_event_id;
+    os_event_t event = os_task_event;
+    os_uint32_t served = 0;
+#ifdef OS_POST_EN
+    os_uint32_t arg = os_event_arg;
+#endif
+#ifdef OS_EVENT_COUNT_EN
+    os_uint8_t cnt[OS_TASK_EVENT_MAX];
+    os_uint8_t i;
 
-    /* Power on reset hook */
-    os_board_init();
-    
+    for( i = 0; i < OS_TASK_EVENT_MAX; i++ )
+        cnt[i] = os_event_cnt[i];
+#endif
+
+    for( os_task_id = __os_task_urgent_get( served ); os_task_id != os_task_max; os_task_id = __os_task_urgent_get( served ) )
+    {
+        served |= (os_uint32_t)1 << os_task_id;
+        os_sched_run();
+    }
+
+#ifdef OS_EVENT_COUNT_EN
+    for( i = 0; i < OS_TASK_EVENT_MAX; i++ )
+        os_event_cnt[i] = cnt[i];
+#endif
+#ifdef OS_POST_EN
+    os_event_arg = arg;
+#endif
+    os_task_event = event;
+    os_event_id = event_id;
+    os_task_id = task_id;
+}
+#endif
+
+#ifdef OS_EVENT_COUNT_EN
+/*
+ * Times a counted event of the running task was set since it was last
+ * handled, UINT8_MAX if it saturated. Always 1 for other events.
+ */
+os_uint8_t os_task_event_count( os_int8_t event_id )
+{
+    OS_ASSERT( event_id >= 0 && event_id < OS_TASK_EVENT_MAX );
+    if( os_task_list[os_task_id].event_counted & BV( event_id ) )
+    {
+        return os_event_cnt[event_id];
+    }
+    return 1;
+}
+#endif
+
+#ifdef OS_POST_EN
+/* argument of the event being handled if it was posted, 0 otherwise */
+os_uint32_t os_task_event_arg( void )
+{
+    return os_event_arg;
+}
+#endif
+
+int main( void )
+{
+    /* No interrupt is armed before the board init, the kernel sets up its
+       own state with interrupts enabled */
 #ifdef OS_MEM_EN
     __os_mem_init();
 #endif /* (OS_MEM_EN > 0) */
 
+#ifdef OS_MSG_EN
+    __os_msg_init();
+#endif
+
 #ifdef OS_CLOCK_EN
     __os_clock_init();
 #endif
@@ -66,9 +203,36 @@ int main( void )
     __os_timer_init();
 #endif /* (OS_TIMER_EN > 0) */
 
+#ifdef OS_DEFER_EN
+    __os_defer_init();
+#endif
+
+    /* Disable Interrupts */
+    OS_ENTER_CRITICAL();
+
+    /* Power on reset hook */
+    os_board_init();
+
     /* Enable Interrupts */
     OS_EXIT_CRITICAL();
 
+#ifdef OS_LOAD_EN
+    __os_load_init();
+#endif
+
+#ifdef OS_CRITICAL_STATS_EN
+    /* the board init is not bounded, measure from the scheduler on */
+    os_critical_max_reset();
+#endif
+
+    OS_ASSERT( os_task_max <= OS_TASK_MAX );
+#ifdef OS_URGENT_EN
+    for( os_task_id = 32; os_task_id < os_task_max; os_task_id++ )
+    {
+        OS_ASSERT( !os_task_list[os_task_id].urgent );
+    }
+#endif
+
     for( os_task_id = 0; os_task_id < os_task_max; os_task_id++ )
     {
         if(os_task_list[os_task_id].p_task_init)
@@ -85,55 +249,260 @@ int main( void )
         __os_clock_update();
 #endif // (OS_TIMER_EN > 0)
 #endif // (OS_CLOCK_EN > 0)
-        
-        for( os_task_id = 0; os_task_id < os_task_max; os_task_id++ )
+
+#ifdef OS_LOAD_EN
+        __os_load_update();
+#endif
+
+#ifdef OS_RPC_EN
+        __os_rpc_process();
+#endif
+
+#ifdef OS_DEFER_EN
+        __os_defer_process();
+#endif
+
+#ifdef OS_URGENT_EN
+        /* urgent work an entry left behind */
+        if( __os_task_urgent_get( 0 ) != os_task_max )
+            OS_URGENT_PEND();
+#endif
+
+        os_task_id = __os_task_ready_get();
+        if( os_task_id == os_task_max )
         {
-#ifdef OS_MSG_EN
-            if( os_task_tcb[os_task_id].phead )
-            {
-                os_task_list[os_task_id].p_task_handler( OS_TASK_EVT_MSG );
-                break;
-            }
+            /* idle work counts as idle time, it only soaks up what is left */
+#ifdef OS_LOAD_EN
+            __os_load_idle_begin();
+#endif
+#ifdef OS_IDLE_EN
+            /* one slice per pass, a task readied meanwhile goes first */
+            if( !__os_idle_process() )
 #endif
-            
-            OS_ENTER_CRITICAL();
-            os_task_event = os_task_tcb[os_task_id].event;
-            OS_EXIT_CRITICAL();
-            
-            if( os_task_event )
             {
-                os_event_id = 0;
-                while( (os_task_event & BV(os_event_id)) == 0 )
-                {
-                    os_event_id++;
-                }
-                os_task_event = BV( os_event_id );
-                
-                OS_ENTER_CRITICAL();
-                if( os_task_tcb[os_task_id].event & os_task_event )
-                {
-                    os_task_tcb[os_task_id].event &= ~os_task_event;
-                    OS_EXIT_CRITICAL();
-                    OS_ASSERT( os_task_list[os_task_id].p_task_handler != NULL );
-                    os_task_list[os_task_id].p_task_handler( os_event_id );
-                }
-                else
-                {
-                    OS_EXIT_CRITICAL();
-                }
-                break;
+#ifdef OS_TICKLESS_EN
+                os_sched_sleep();
+#else
+                os_board_idle();
+#endif
             }
+#ifdef OS_LOAD_EN
+            __os_load_idle_end();
+#endif
+            continue;
         }
 
-        if( os_task_id == os_task_max )
-        {
-            os_board_idle();
-        }
+        os_sched_run();
     }
     //return 0;
 }
 
 /* Private function implementations ------------------------------------------*/
+/* hands os_task_id its next message, mailbox slot, posted event or event */
+static void os_sched_run( void )
+{
+#ifdef OS_MSG_EN
+    os_uint8_t batch;
+
+    if( __os_msg_pending( os_task_id ) )
+    {
+        /* a burst is handed over in one pass, up to the batch of the task */
+        batch = os_task_list[os_task_id].msg_batch ? os_task_list[os_task_id].msg_batch : OS_MSG_BATCH;
+        do {
+#ifdef OS_CO_EN
+            /* os_msg_recv() clears it, a coroutine awaiting an event takes
+               nothing, leaves its messages queued and gets its events until
+               it receives again */
+            os_task_tcb[os_task_id].msg_hold = os_task_list[os_task_id].co;
+#endif
+            os_sched_dispatch( OS_TASK_EVT_MSG );
+        } while( --batch && __os_msg_pending( os_task_id ) );
+        return;
+    }
+#endif
+
+#ifdef OS_MBOX_EN
+    if( __os_mbox_pending( os_task_id ) )
+    {
+        os_sched_dispatch( OS_TASK_EVT_MBOX );
+        return;
+    }
+#endif
+
+#ifdef OS_POST_EN
+    if( __os_task_post_get( os_task_id, &os_event_id, &os_event_arg ) == OS_ERR_NONE )
+    {
+        os_task_event = (os_event_t)BV( os_event_id );
+#ifdef OS_EVENT_COUNT_EN
+        os_event_cnt[os_event_id] = 1;
+#endif
+        os_sched_dispatch( os_event_id );
+        os_event_arg = 0;
+        return;
+    }
+#endif
+
+    os_task_event = os_task_tcb[os_task_id].event;
+    if( os_task_event == 0 )
+    {
+        /* stale ready bit, nothing left to deliver */
+        __os_task_ready_clr( os_task_id );
+        return;
+    }
+
+    /* interrupts only add events, so the lowest one seen is still pending */
+    os_event_id = (os_int8_t)OS_CTZ32( os_task_event );
+#ifdef OS_EVENT_MASK_EN
+    if( os_task_list[os_task_id].p_task_handler_mask )
+    {
+        os_task_event = OS_ATOMIC_FETCH_AND( &os_task_tcb[os_task_id].event, 0 );
+        os_event_id = (os_int8_t)OS_CTZ32( os_task_event );
+    }
+    else
+#endif
+    {
+        os_task_event = (os_event_t)BV( os_event_id );
+        OS_ATOMIC_FETCH_AND( &os_task_tcb[os_task_id].event, (os_event_t)~os_task_event );
+    }
+
+#ifdef OS_EVENT_COUNT_EN
+    if( (os_task_event & os_task_list[os_task_id].event_counted) && os_sched_count() == 0 )
+    {
+        return;
+    }
+#endif
+
+    os_sched_dispatch( os_event_id );
+}
+
+static void os_sched_dispatch( os_int8_t event_id )
+{
+#ifdef OS_PROFILE_EN
+    os_uint32_t cycles;
+#endif
+
+#ifdef OS_URGENT_EN
+    /* not served, budgeted nor profiled, its time shows in the handler it preempted */
+    if( os_task_list[os_task_id].urgent )
+    {
+        os_sched_call( event_id );
+        return;
+    }
+#endif
+
+    __os_task_served( os_task_id );
+#ifdef OS_BUDGET_EN
+    __os_budget_begin( os_task_id, event_id );
+#endif
+#ifdef OS_PROFILE_EN
+    cycles = OS_CYCLE_COUNTER();
+#endif
+    /* profile and budget charge a whole batch to its lowest event */
+    os_sched_call( event_id );
+#ifdef OS_PROFILE_EN
+    __os_profile_record( os_task_id, event_id, OS_CYCLE_COUNTER() - cycles );
+#endif
+#ifdef OS_BUDGET_EN
+    __os_budget_end();
+#endif
+}
+
+static void os_sched_call( os_int8_t event_id )
+{
+    OS_TRACE( OS_TRACE_DISPATCH_BEGIN, os_task_id, event_id );
+#ifdef OS_EVENT_MASK_EN
+    if( event_id >= 0 && os_task_list[os_task_id].p_task_handler_mask )
+    {
+        os_task_list[os_task_id].p_task_handler_mask( os_task_event );
+    }
+    else
+#endif
+    {
+        OS_ASSERT( os_task_list[os_task_id].p_task_handler != NULL );
+        os_task_list[os_task_id].p_task_handler( event_id );
+    }
+    OS_TRACE( OS_TRACE_DISPATCH_END, os_task_id, event_id );
+}
+
+#ifdef OS_EVENT_COUNT_EN
+/*
+ * Takes the counts of the counted events about to be delivered. The event
+ * bit is cleared before its count is taken, so a set racing with the
+ * scheduler may leave a bit whose count an earlier pass already took.
+ * Such events are dropped from the delivery, returns what is left.
+ */
+static os_event_t os_sched_count( void )
+{
+    os_event_t counted;
+    os_int8_t event_id;
+
+    counted = os_task_event & os_task_list[os_task_id].event_counted;
+    while( counted )
+    {
+        event_id = (os_int8_t)OS_CTZ32( counted );
+        counted &= counted - 1;
+        os_event_cnt[event_id] = __os_task_event_cnt_take( os_task_id, event_id );
+        if( os_event_cnt[event_id] == 0 )
+        {
+            os_task_event &= (os_event_t)~BV( event_id );
+        }
+    }
+
+    if( os_task_event )
+    {
+        os_event_id = (os_int8_t)OS_CTZ32( os_task_event );
+    }
+    return os_task_event;
+}
+#endif
+
+#ifdef OS_TICKLESS_EN
+static void os_sched_sleep( void )
+{
+    os_uint32_t tick;
+    os_uint32_t pending;
+
+#ifdef OS_TIMER_EN
+    tick = __os_timer_next();
+#else
+    tick = UINT32_MAX;
+#endif
+#ifdef OS_RPC_EN
+    /* wake for the nearest call timeout too */
+    if( __os_rpc_next() < tick )
+    {
+        tick = __os_rpc_next();
+    }
+#endif
+
+    OS_ENTER_CRITICAL();
+    /* an ISR may have readied a task since the scheduler looked, the board
+       sleeps with interrupts masked so a pending one still wakes the core */
+    if( __os_task_ready_get() == os_task_max
+#ifdef OS_DEFER_EN
+        && !__os_defer_pending()
+#endif
+#ifdef OS_IDLE_EN
+        && !__os_idle_pending()
+#endif
+      )
+    {
+        /* the deadline counts from the last clock update, ticks since then
+           are already gone, none left means it is due and the next pass runs it */
+        pending = __os_clock_pending();
+        if( tick > pending )
+        {
+            /* credited before any interrupt runs, so os_systick never lags the
+               ticks slept, the next pass hands them to the clock and the timers */
+            __os_clock_credit( os_board_sleep( tick - pending ) );
+#ifdef OS_INT_SAVE
+            __os_critical_restart();
+#endif
+        }
+    }
+    OS_EXIT_CRITICAL();
+}
+#endif //OS_TICKLESS_EN
 
 /****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
 
@@ -14,14 +14,70 @@
 
 /* Exported variables --------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
+#define OS_TASK_READY_GRP_MAX       ((OS_TASK_MAX + 31) >> 5)
+
 /* Private typedef -----------------------------------------------------------*/
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 extern const OS_TASK_t *os_task_list;
 extern OS_TCB_t *os_task_tcb;
 extern const os_uint8_t os_task_max;
+#ifdef OS_SCHED_STATS_EN
+extern volatile os_uint32_t os_systick;
+#endif
+
+/*
+ * Ready bitmap, one bit per task, bit n of word g is task (g * 32 + n).
+ * A set bit means the task has a pending event or message. The bit may be
+ * left set after the last event is consumed, the scheduler drops it lazily,
+ * but it is never left clear while the task has work.
+ */
+#if OS_TASK_READY_GRP_MAX > 1
+static os_uint32_t os_task_ready_grp;
+#endif
+static os_uint32_t os_task_ready_tbl[OS_TASK_READY_GRP_MAX];
+
+/* ready urgent tasks, kept out of the bitmap above so main() never picks them */
+#ifdef OS_URGENT_EN
+static os_uint32_t os_task_urgent_ready;
+#endif
+
+#if OS_SCHED_POLICY == OS_SCHED_POLICY_RR
+static os_uint8_t os_sched_last;
+#endif
+
+#ifdef OS_CLZ32_SOFT
+static const os_uint8_t os_ctz32_tbl[32] = {
+     0,  1, 28,  2, 29, 14, 24,  3, 30, 22, 20, 15, 25, 17,  4,  8,
+    31, 27, 13, 23, 21, 19, 16,  7, 26, 12, 18,  6, 11,  5, 10,  9
+};
+#endif
 
 /* Private function prototypes -----------------------------------------------*/
+void __os_task_ready_set( os_uint8_t task_id );
+void __os_task_ready_clr( os_uint8_t task_id );
+os_uint8_t __os_task_ready_get( void );
+void __os_task_served( os_uint8_t task_id );
+#ifdef OS_URGENT_EN
+os_uint8_t __os_task_urgent_get( os_uint32_t skip );
+#endif
+#ifdef OS_POST_EN
+os_err_t __os_task_post_get( os_uint8_t task_id, os_int8_t *p_event_id, os_uint32_t *p_arg );
+#endif
+#ifdef OS_EVENT_COUNT_EN
+os_uint8_t __os_task_event_cnt_take( os_uint8_t task_id, os_int8_t event_id );
+#endif
+#ifdef OS_MSG_EN
+extern os_uint8_t __os_msg_pending( os_uint8_t task_id );
+#endif
+#ifdef OS_MBOX_EN
+extern os_uint8_t __os_mbox_pending( os_uint8_t task_id );
+#endif
+static os_uint8_t os_task_ready_from( os_uint16_t start );
+#ifdef OS_ATOMIC_SOFT
+static os_uint32_t os_atomic_update( volatile void *p, os_uint32_t or_v, os_uint32_t and_v, os_uint32_t add_v, os_uint8_t size );
+#endif
+
 /* Exported function implementations -----------------------------------------*/
 void os_task_set_event   ( os_uint8_t task_id, os_int8_t event_id )
 {
@@ -29,9 +85,24 @@ void os_task_set_event   ( os_uint8_t task_id, os_int8_t event_id )
     OS_ASSERT( task_id < os_task_max && event_id >= 0 );
     
     event = BV(event_id);
-    OS_ENTER_CRITICAL();
-    os_task_tcb[task_id].event |= event;
-    OS_EXIT_CRITICAL();
+    OS_TRACE( OS_IN_ISR() ? OS_TRACE_EVENT_SET_ISR : OS_TRACE_EVENT_SET, task_id, event_id );
+#ifdef OS_EVENT_COUNT_EN
+    if( os_task_list[task_id].event_counted & event )
+    {
+        OS_ENTER_CRITICAL();
+        if( os_task_list[task_id].p_event_cnt[event_id] == UINT8_MAX )
+        {
+            os_task_tcb[task_id].event_ovf |= event;
+        }
+        else
+        {
+            os_task_list[task_id].p_event_cnt[event_id]++;
+        }
+        OS_EXIT_CRITICAL();
+    }
+#endif
+    OS_ATOMIC_FETCH_OR( &os_task_tcb[task_id].event, event );
+    __os_task_ready_set( task_id );
 }
 
 void os_task_clr_event   ( os_uint8_t task_id, os_int8_t event_id )
@@ -40,12 +111,470 @@ void os_task_clr_event   ( os_uint8_t task_id, os_int8_t event_id )
     OS_ASSERT( task_id < os_task_max && event_id >= 0 );
     
     event = ~(BV(event_id));
+#ifdef OS_EVENT_COUNT_EN
+    if( os_task_list[task_id].event_counted & ~event )
+    {
+        __os_task_event_cnt_take( task_id, event_id );
+    }
+#endif
+    if( (OS_ATOMIC_FETCH_AND( &os_task_tcb[task_id].event, event ) & event) == 0 )
+    {
+#ifdef OS_MSG_EN
+        if( !__os_msg_pending( task_id ) )
+#endif
+#ifdef OS_MBOX_EN
+        if( !__os_mbox_pending( task_id ) )
+#endif
+        __os_task_ready_clr( task_id );
+    }
+}
+
+#ifdef OS_POST_EN
+/*
+ * Queues an event with a 32-bit argument for the task, delivered in the
+ * order posted and before its plain events. Unlike os_task_set_event() the
+ * same event may be posted several times, nothing is coalesced. May be
+ * called from interrupts.
+ */
+os_err_t os_task_post_event( os_uint8_t task_id, os_int8_t event_id, os_uint32_t arg )
+{
+    os_uint16_t index;
+    OS_POST_t *p_post;
+
+    OS_ASSERT( task_id < os_task_max && event_id >= 0 && event_id < OS_TASK_EVENT_MAX );
+    OS_ASSERT( os_task_list[task_id].p_post != NULL );
+
+    OS_ENTER_CRITICAL();
+    if( os_task_tcb[task_id].post_cnt >= os_task_list[task_id].post_max )
+    {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_FULL;
+    }
+    index = (os_uint16_t)os_task_tcb[task_id].post_head + os_task_tcb[task_id].post_cnt;
+    if( index >= os_task_list[task_id].post_max )
+    {
+        index -= os_task_list[task_id].post_max;
+    }
+    p_post = &os_task_list[task_id].p_post[index];
+    p_post->event_id = event_id;
+    p_post->arg = arg;
+    os_task_tcb[task_id].post_cnt++;
+    OS_EXIT_CRITICAL();
+
+    OS_TRACE( OS_TRACE_POST, task_id, event_id );
+
+    __os_task_ready_set( task_id );
+    return OS_ERR_NONE;
+}
+#endif
+
+#ifdef OS_CO_EN
+/* resume line of the running task's coroutine, used by OS_CO_BEGIN() */
+os_uint16_t *os_task_co_line( void )
+{
+    return &os_task_tcb[os_get_task_id_self()].co_line;
+}
+#endif
+
+#ifdef OS_EVENT_COUNT_EN
+/* counted events of the task that saturated since the last call */
+os_event_t os_task_event_overflow( os_uint8_t task_id )
+{
+    OS_ASSERT( task_id < os_task_max );
+    return (os_event_t)OS_ATOMIC_FETCH_AND( &os_task_tcb[task_id].event_ovf, 0 );
+}
+#endif
+
+/* tasks with work pending, a snapshot for load and backlog heuristics */
+os_uint8_t os_task_ready_count( void )
+{
+    os_uint32_t map;
+    os_uint8_t grp;
+    os_uint8_t cnt = 0;
+
+    for( grp = 0; grp < OS_TASK_READY_GRP_MAX; grp++ )
+    {
+        for( map = os_task_ready_tbl[grp]; map; map &= map - 1 )
+        {
+            cnt++;
+        }
+    }
+
+    return cnt;
+}
+
+#ifdef OS_SCHED_STATS_EN
+/*
+ * Longest time in ticks the task waited between becoming ready and being
+ * served, including the wait still in progress for a task starved right now.
+ */
+os_uint32_t os_task_wait_max( os_uint8_t task_id )
+{
+    os_uint32_t wait = 0;
+
+    OS_ASSERT( task_id < os_task_max );
+
     OS_ENTER_CRITICAL();
-    os_task_tcb[task_id].event &= event;
+    if( os_task_ready_tbl[task_id >> 5] & ((os_uint32_t)1 << (task_id & 0x1F)) )
+    {
+        wait = os_systick - os_task_tcb[task_id].ready_tick;
+    }
     OS_EXIT_CRITICAL();
+
+    return MAX( wait, os_task_tcb[task_id].wait_max );
+}
+
+void os_task_wait_max_reset( os_uint8_t task_id )
+{
+    OS_ASSERT( task_id < os_task_max );
+    os_task_tcb[task_id].wait_max = 0;
+}
+#endif
+
+os_uint8_t os_clz32( os_uint32_t x )
+{
+#ifdef OS_CLZ32_SOFT
+    os_uint8_t n = 0;
+#endif
+
+    OS_ASSERT( x != 0 );
+#ifdef OS_CLZ32_SOFT
+    if( x <= 0x0000FFFFUL ) { n += 16; x <<= 16; }
+    if( x <= 0x00FFFFFFUL ) { n +=  8; x <<=  8; }
+    if( x <= 0x0FFFFFFFUL ) { n +=  4; x <<=  4; }
+    if( x <= 0x3FFFFFFFUL ) { n +=  2; x <<=  2; }
+    if( x <= 0x7FFFFFFFUL ) { n +=  1; }
+    return n;
+#else
+    return (os_uint8_t)OS_CLZ32( x );
+#endif
+}
+
+os_uint8_t os_ctz32( os_uint32_t x )
+{
+    OS_ASSERT( x != 0 );
+#ifdef OS_CLZ32_SOFT
+    return os_ctz32_tbl[((os_uint32_t)((x & (0 - x)) * 0x077CB531UL)) >> 27];
+#else
+    return OS_CTZ32( x );
+#endif
+}
+
+#ifdef OS_ATOMIC_SOFT
+os_uint32_t os_atomic_fetch_or( volatile void *p, os_uint32_t v, os_uint8_t size )
+{
+    return os_atomic_update( p, v, UINT32_MAX, 0, size );
+}
+
+os_uint32_t os_atomic_fetch_and( volatile void *p, os_uint32_t v, os_uint8_t size )
+{
+    return os_atomic_update( p, 0, v, 0, size );
+}
+
+os_uint32_t os_atomic_fetch_add( volatile void *p, os_uint32_t v, os_uint8_t size )
+{
+    return os_atomic_update( p, 0, UINT32_MAX, v, size );
+}
+
+/* pointers are 32 bits wide on every target without the builtins */
+void *os_atomic_xchg_ptr( volatile void *p, void *v )
+{
+    return (void *)os_atomic_update( p, (os_uint32_t)v, 0, 0, 4 );
 }
+#endif
 
 /* Private function implementations ------------------------------------------*/
+/* safe from interrupts, the event must be raised before the bit is set */
+void __os_task_ready_set( os_uint8_t task_id )
+{
+    os_uint32_t bit = (os_uint32_t)1 << (task_id & 0x1F);
 
-/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
+#ifdef OS_URGENT_EN
+    if( os_task_list[task_id].urgent )
+    {
+        OS_ATOMIC_FETCH_OR( &os_task_urgent_ready, bit );
+        OS_URGENT_PEND();
+        return;
+    }
+#endif
+
+#ifdef OS_SCHED_STATS_EN
+    if( (OS_ATOMIC_FETCH_OR( &os_task_ready_tbl[task_id >> 5], bit ) & bit) == 0 )
+    {
+        os_task_tcb[task_id].ready_tick = os_systick;
+    }
+#else
+    OS_ATOMIC_FETCH_OR( &os_task_ready_tbl[task_id >> 5], bit );
+#endif
+#if OS_TASK_READY_GRP_MAX > 1
+    OS_ATOMIC_FETCH_OR( &os_task_ready_grp, (os_uint32_t)BV( task_id >> 5 ) );
+#endif
+}
+
+/*
+ * Task context or the urgent level only. The bit is cleared first and the
+ * task looked at again afterwards, so an event an interrupt raises in
+ * between sets it back instead of being lost, without masking interrupts.
+ */
+void __os_task_ready_clr( os_uint8_t task_id )
+{
+    os_uint32_t bit = (os_uint32_t)1 << (task_id & 0x1F);
+
+#ifdef OS_URGENT_EN
+    if( os_task_list[task_id].urgent )
+    {
+        OS_ATOMIC_FETCH_AND( &os_task_urgent_ready, ~bit );
+    }
+    else
+#endif
+#if OS_TASK_READY_GRP_MAX > 1
+    if( OS_ATOMIC_FETCH_AND( &os_task_ready_tbl[task_id >> 5], ~bit ) == bit )
+    {
+        OS_ATOMIC_FETCH_AND( &os_task_ready_grp, ~(os_uint32_t)BV( task_id >> 5 ) );
+        if( os_task_ready_tbl[task_id >> 5] )
+        {
+            OS_ATOMIC_FETCH_OR( &os_task_ready_grp, (os_uint32_t)BV( task_id >> 5 ) );
+        }
+    }
+#else
+    {
+        OS_ATOMIC_FETCH_AND( &os_task_ready_tbl[0], ~bit );
+    }
+#endif
+
+    if( os_task_tcb[task_id].event
+#ifdef OS_MSG_EN
+        || __os_msg_pending( task_id )
+#endif
+#ifdef OS_MBOX_EN
+        || __os_mbox_pending( task_id )
+#endif
+#ifdef OS_POST_EN
+        || os_task_tcb[task_id].post_cnt
+#endif
+      )
+    {
+        __os_task_ready_set( task_id );
+    }
+}
+
+#ifdef OS_EVENT_COUNT_EN
+/* takes the count of a counted event, 0 if it was already taken */
+os_uint8_t __os_task_event_cnt_take( os_uint8_t task_id, os_int8_t event_id )
+{
+    os_uint8_t cnt;
+
+    OS_ENTER_CRITICAL();
+    cnt = os_task_list[task_id].p_event_cnt[event_id];
+    os_task_list[task_id].p_event_cnt[event_id] = 0;
+    OS_EXIT_CRITICAL();
+
+    return cnt;
+}
+#endif
+
+#ifdef OS_POST_EN
+/* takes the oldest posted event of the task, OS_ERR_EMPTY if there is none */
+os_err_t __os_task_post_get( os_uint8_t task_id, os_int8_t *p_event_id, os_uint32_t *p_arg )
+{
+    OS_POST_t *p_post;
+
+    OS_ENTER_CRITICAL();
+    if( os_task_tcb[task_id].post_cnt == 0 )
+    {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_EMPTY;
+    }
+    p_post = &os_task_list[task_id].p_post[os_task_tcb[task_id].post_head];
+    *p_event_id = p_post->event_id;
+    *p_arg = p_post->arg;
+    if( ++os_task_tcb[task_id].post_head >= os_task_list[task_id].post_max )
+    {
+        os_task_tcb[task_id].post_head = 0;
+    }
+    os_task_tcb[task_id].post_cnt--;
+    OS_EXIT_CRITICAL();
+
+    return OS_ERR_NONE;
+}
+#endif
+
+/*
+ * Returns the next task to run under OS_SCHED_POLICY, os_task_max if none.
+ * Ready bits are only cleared from task context and interrupts can only add
+ * them, so the bitmap is read without masking interrupts. It may be called
+ * with interrupts masked as well.
+ */
+os_uint8_t __os_task_ready_get( void )
+{
+#if OS_SCHED_POLICY == OS_SCHED_POLICY_RR
+    os_uint8_t task_id;
+
+    /* resume after the task served last, then wrap around */
+    task_id = os_task_ready_from( (os_uint16_t)os_sched_last + 1 );
+    if( task_id == os_task_max )
+    {
+        task_id = os_task_ready_from( 0 );
+    }
+    return task_id;
+#elif OS_SCHED_POLICY == OS_SCHED_POLICY_WFQ
+    os_uint8_t task_id;
+    os_uint8_t first;
+
+    /* highest priority ready task with credit left, in priority order */
+    first = os_task_ready_from( 0 );
+    for( task_id = first; task_id < os_task_max; task_id = os_task_ready_from( (os_uint16_t)task_id + 1 ) )
+    {
+        if( os_task_tcb[task_id].credit )
+        {
+            return task_id;
+        }
+    }
+
+    /* every ready task spent its credit, start a new round */
+    if( first < os_task_max )
+    {
+        for( task_id = 0; task_id < os_task_max; task_id++ )
+        {
+            os_task_tcb[task_id].credit = os_task_list[task_id].weight ? os_task_list[task_id].weight : 1;
+        }
+    }
+    return first;
+#else
+    return os_task_ready_from( 0 );
+#endif
+}
+
+#ifdef OS_URGENT_EN
+/* lowest ready urgent task not in skip, os_task_max if none */
+os_uint8_t __os_task_urgent_get( os_uint32_t skip )
+{
+    os_uint32_t map = os_task_urgent_ready & ~skip;
+
+    return map ? OS_CTZ32( map ) : os_task_max;
+}
+#endif
+
+/* called by the scheduler each time a task is handed an event or message */
+void __os_task_served( os_uint8_t task_id )
+{
+#ifdef OS_SCHED_STATS_EN
+    os_uint32_t wait;
+
+    OS_ENTER_CRITICAL();
+    wait = os_systick - os_task_tcb[task_id].ready_tick;
+    os_task_tcb[task_id].ready_tick = os_systick;
+    OS_EXIT_CRITICAL();
+
+    if( wait > os_task_tcb[task_id].wait_max )
+    {
+        os_task_tcb[task_id].wait_max = wait;
+    }
+#endif
+
+#if OS_SCHED_POLICY == OS_SCHED_POLICY_RR
+    os_sched_last = task_id;
+#elif OS_SCHED_POLICY == OS_SCHED_POLICY_WFQ
+    if( os_task_tcb[task_id].credit )
+    {
+        os_task_tcb[task_id].credit--;
+    }
+#else
+    (void)task_id;
+#endif
+}
+
+#ifdef OS_ATOMIC_SOFT
+/* new value is ((old & and_v) | or_v) + add_v, returns the old value */
+static os_uint32_t os_atomic_update( volatile void *p, os_uint32_t or_v, os_uint32_t and_v, os_uint32_t add_v, os_uint8_t size )
+{
+    os_uint32_t old;
+
+#if defined(__ICCARM__) && (__CORE__ == __ARM7M__ || __CORE__ == __ARM7EM__)
+    switch( size )
+    {
+    case 1:
+        do {
+            old = __LDREXB( (unsigned char *)p );
+        } while( __STREXB( (unsigned char)(((old & and_v) | or_v) + add_v), (unsigned char *)p ) );
+        break;
+    case 2:
+        do {
+            old = __LDREXH( (unsigned short *)p );
+        } while( __STREXH( (unsigned short)(((old & and_v) | or_v) + add_v), (unsigned short *)p ) );
+        break;
+    default:
+        do {
+            old = __LDREX( (unsigned long *)p );
+        } while( __STREX( ((old & and_v) | or_v) + add_v, (unsigned long *)p ) );
+        break;
+    }
+#else
+#ifdef OS_INT_SAVE
+    os_uint32_t state = OS_INT_SAVE();
+#else
+    OS_ENTER_CRITICAL();
+#endif
+    switch( size )
+    {
+    case 1:
+        old = *(volatile os_uint8_t *)p;
+        *(volatile os_uint8_t *)p = (os_uint8_t)(((old & and_v) | or_v) + add_v);
+        break;
+    case 2:
+        old = *(volatile os_uint16_t *)p;
+        *(volatile os_uint16_t *)p = (os_uint16_t)(((old & and_v) | or_v) + add_v);
+        break;
+    default:
+        old = *(volatile os_uint32_t *)p;
+        *(volatile os_uint32_t *)p = ((old & and_v) | or_v) + add_v;
+        break;
+    }
+#ifdef OS_INT_SAVE
+    OS_INT_RESTORE( state );
+#else
+    OS_EXIT_CRITICAL();
+#endif
+#endif
+
+    return old;
+}
+#endif
+
+/* first ready task with an id not below start, os_task_max if none */
+static os_uint8_t os_task_ready_from( os_uint16_t start )
+{
+    os_uint32_t map;
+#if OS_TASK_READY_GRP_MAX > 1
+    os_uint8_t grp;
+#endif
+
+    if( start >= os_task_max )
+        return os_task_max;
+
+#if OS_TASK_READY_GRP_MAX > 1
+    grp = (os_uint8_t)( start >> 5 );
+    map = os_task_ready_tbl[grp] & ( UINT32_MAX << (start & 0x1F) );
+    if( map )
+    {
+        return (os_uint8_t)((grp << 5) + OS_CTZ32( map ));
+    }
+
+    map = os_task_ready_grp & ( UINT32_MAX << (grp + 1) );
+    if( map )
+    {
+        grp = OS_CTZ32( map );
+        return (os_uint8_t)((grp << 5) + OS_CTZ32( os_task_ready_tbl[grp] ));
+    }
+#else
+    map = os_task_ready_tbl[0] & ( UINT32_MAX << start );
+    if( map )
+    {
+        return OS_CTZ32( map );
+    }
+#endif
 
+    return os_task_max;
+}
+
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
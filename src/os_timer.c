@@ -44,7 +44,10 @@ static OS_TIMER_t os_timer_list[OS_TIMER_MAX];
 #endif //OS_TIMER_USE_HEAP
 /* Private function declarations ------------------------------------------*/
 void __os_timer_init( void );
-void __os_timer_process( os_uint8_t delta_systick );
+void __os_timer_process( os_uint32_t delta_systick );
+#ifdef OS_TICKLESS_EN
+os_uint32_t __os_timer_next( void );
+#endif
 
 /* Private function implementations ------------------------------------------*/
 #ifdef OS_TIMER_USE_HEAP
@@ -127,6 +130,7 @@ static void os_timer_event_kernel ( void *p_arg )
     u16tmp = (os_uint16_t)( (os_uint32_t)p_arg );
     task_id = (os_uint8_t)HI_UINT16( u16tmp );
     event_id = (os_int8_t)LO_UINT16( u16tmp );
+    OS_TRACE( OS_TRACE_TIMER_FIRE, task_id, event_id );
     os_task_set_event( task_id, event_id );
 }
 
@@ -158,6 +162,7 @@ static void    *os_timer_cback_create ( void ( *p_fxn )( void * ), void *p_arg,
     p_timer_new = os_mem_alloc( sizeof(OS_TIMER_t) );
     if( p_timer_new != NULL )
     {
+        OS_TRACE( OS_TRACE_ALLOC, os_get_task_id_self(), sizeof(OS_TIMER_t) );
         p_timer_new->p_fxn = p_fxn;
         p_timer_new->p_arg = p_arg;
         p_timer_new->timeout = tick;
@@ -182,6 +187,7 @@ static void os_timer_cback_delete ( void *timer_id )
     //OS_ASSERT( os_timer_list_find( (OS_TIMER_t *)timer_id ) != NULL );
     os_timer_list_del( (OS_TIMER_t *)timer_id );
     os_mem_free( timer_id );
+    OS_TRACE( OS_TRACE_FREE, os_get_task_id_self(), sizeof(OS_TIMER_t) );
 }
 
 //static uint32_t os_timer_cback_query  ( void *timer_id )
@@ -232,7 +238,7 @@ void __os_timer_init( void )
 #endif
 }
 
-void __os_timer_process( os_uint8_t delta_systick )
+void __os_timer_process( os_uint32_t delta_systick )
 {
 #ifdef OS_TIMER_USE_HEAP
     OS_TIMER_t *p_timer_curr;
@@ -252,6 +258,8 @@ void __os_timer_process( os_uint8_t delta_systick )
     if( delta_systick == 0 )    return;
 
 #ifdef OS_TIMER_USE_HEAP
+    /* urgent tasks may add or unlink timers, hold them off the whole walk */
+    OS_URGENT_LOCK();
     if( p_timers_head )
     {
         //OS_ASSERT( p_timers_tail != NULL );
@@ -272,25 +280,70 @@ void __os_timer_process( os_uint8_t delta_systick )
                 p_arg = p_timer_curr->p_arg;
                 os_timer_list_del( p_timer_curr );
                 os_mem_free( p_timer_curr );
+                OS_TRACE( OS_TRACE_FREE, os_get_task_id_self(), sizeof(OS_TIMER_t) );
                 p_fxn( p_arg );
             }
         }
     }
+    OS_URGENT_UNLOCK();
 #else
     for( timer_id = 0; timer_id < OS_TIMER_MAX; timer_id++ )
     {
+        OS_URGENT_LOCK();
         if( os_timer_list[timer_id].timeout )
         {
             os_timer_list[timer_id].timeout = ( os_timer_list[timer_id].timeout >= delta_systick ) ? (os_timer_list[timer_id].timeout - delta_systick) : 0;
             if( os_timer_list[timer_id].timeout == 0 )
             {
+                OS_TRACE( OS_TRACE_TIMER_FIRE, os_timer_list[timer_id].task_id, os_timer_list[timer_id].event_id );
                 os_task_set_event( os_timer_list[timer_id].task_id, os_timer_list[timer_id].event_id );
             }
         }
+        OS_URGENT_UNLOCK();
     }
 #endif
 }
 
+#ifdef OS_TICKLESS_EN
+/* returns the ticks left until the nearest timer expires, UINT32_MAX if none */
+os_uint32_t __os_timer_next( void )
+{
+#ifdef OS_TIMER_USE_HEAP
+    OS_TIMER_t *p_timer_curr;
+#else
+#if (OS_TIMER_MAX >= UINT8_MAX)
+    os_uint16_t timer_id;
+#else
+    os_uint8_t  timer_id;
+#endif//(OS_TIMER_MAX >= UINT8_MAX)
+#endif//OS_TIMER_USE_HEAP
+    os_uint32_t tick = UINT32_MAX;
+
+    OS_URGENT_LOCK();
+#ifdef OS_TIMER_USE_HEAP
+    for( p_timer_curr = p_timers_head; p_timer_curr != NULL; p_timer_curr = p_timer_curr->p_timer_next )
+    {
+        if( p_timer_curr->timeout < tick )
+        {
+            tick = p_timer_curr->timeout;
+        }
+    }
+#else
+    for( timer_id = 0; timer_id < OS_TIMER_MAX; timer_id++ )
+    {
+        if( os_timer_list[timer_id].timeout &&
+            os_timer_list[timer_id].timeout < tick )
+        {
+            tick = os_timer_list[timer_id].timeout;
+        }
+    }
+#endif
+    OS_URGENT_UNLOCK();
+
+    return tick;
+}
+#endif //OS_TICKLESS_EN
+
 os_err_t os_timer_create ( os_uint8_t task_id, os_int8_t event_id, os_uint32_t tick )
 {
 #ifdef OS_TIMER_USE_HEAP
@@ -302,12 +355,14 @@ os_err_t os_timer_create ( os_uint8_t task_id, os_int8_t event_id, os_uint32_t t
     os_uint8_t  timer_id;
 #endif//(OS_TIMER_MAX >= UINT8_MAX)
 #endif
+    os_err_t err = OS_ERR_NONE;
 
     OS_ASSERT( task_id < os_task_max &&
                event_id >= 0 &&
                event_id < OS_TASK_EVENT_MAX &&
                tick != 0 );
     
+    OS_URGENT_LOCK();
 #ifdef OS_TIMER_USE_HEAP
     p_timer_match = os_timer_event_find( task_id, event_id );
     if( p_timer_match )
@@ -320,7 +375,7 @@ os_err_t os_timer_create ( os_uint8_t task_id, os_int8_t event_id, os_uint32_t t
         //if not found, create it
         p_timer_match = (void *)os_timer_cback_create( os_timer_event_kernel, (void *)BUILD_UINT16( event_id, task_id ), tick);
         if( p_timer_match == NULL )
-            return OS_ERR_NOMEM;
+            err = OS_ERR_NOMEM;
     }
 #else
     timer_id = os_timer_event_find( task_id, event_id );
@@ -344,10 +399,12 @@ os_err_t os_timer_create ( os_uint8_t task_id, os_int8_t event_id, os_uint32_t t
         }
 
         if( timer_id == OS_TIMER_MAX )
-            return OS_ERR_FULL;
+            err = OS_ERR_FULL;
     }
 #endif
-    return OS_ERR_NONE;
+    OS_URGENT_UNLOCK();
+
+    return err;
 }
 
 os_err_t os_timer_update ( os_uint8_t task_id, os_int8_t event_id, os_uint32_t tick )
@@ -361,12 +418,14 @@ os_err_t os_timer_update ( os_uint8_t task_id, os_int8_t event_id, os_uint32_t t
     os_uint8_t  timer_id;
 #endif//(OS_TIMER_MAX >= UINT8_MAX)
 #endif
+    os_err_t err = OS_ERR_NONE;
 
     OS_ASSERT( task_id < os_task_max &&
                event_id >= 0 &&
                event_id < OS_TASK_EVENT_MAX &&
                tick != 0 );
 
+    OS_URGENT_LOCK();
 #ifdef OS_TIMER_USE_HEAP
     p_timer_match = os_timer_event_find( task_id, event_id );
     if( p_timer_match )
@@ -375,7 +434,7 @@ os_err_t os_timer_update ( os_uint8_t task_id, os_int8_t event_id, os_uint32_t t
     }
     else
     {
-        return OS_ERR_GENERIC;
+        err = OS_ERR_GENERIC;
     }
 #else
     timer_id = os_timer_event_find( task_id, event_id );
@@ -385,10 +444,12 @@ os_err_t os_timer_update ( os_uint8_t task_id, os_int8_t event_id, os_uint32_t t
     }
     else
     {
-        return OS_ERR_GENERIC;
+        err = OS_ERR_GENERIC;
     }
 #endif
-    return OS_ERR_NONE;
+    OS_URGENT_UNLOCK();
+
+    return err;
 }
 
 os_err_t os_timer_delete ( os_uint8_t task_id, os_int8_t event_id )
@@ -402,11 +463,13 @@ os_err_t os_timer_delete ( os_uint8_t task_id, os_int8_t event_id )
     os_uint8_t  timer_id;
 #endif//(OS_TIMER_MAX >= UINT8_MAX)
 #endif
+    os_err_t err = OS_ERR_NONE;
 
     OS_ASSERT( task_id < os_task_max &&
                event_id >= 0 &&
                event_id < OS_TASK_EVENT_MAX );
     
+    OS_URGENT_LOCK();
 #ifdef OS_TIMER_USE_HEAP
     p_timer_match = os_timer_event_find( task_id, event_id );
 
@@ -416,7 +479,7 @@ os_err_t os_timer_delete ( os_uint8_t task_id, os_int8_t event_id )
     }
     else
     {
-        return OS_ERR_GENERIC;
+        err = OS_ERR_GENERIC;
     }
 #else
     timer_id = os_timer_event_find( task_id, event_id );
@@ -426,11 +489,12 @@ os_err_t os_timer_delete ( os_uint8_t task_id, os_int8_t event_id )
     }
     else
     {
-        return OS_ERR_GENERIC;
+        err = OS_ERR_GENERIC;
     }
 #endif
+    OS_URGENT_UNLOCK();
 
-    return OS_ERR_NONE;
+    return err;
 }
 
 os_uint32_t os_timer_query  ( os_uint8_t task_id, os_int8_t event_id )
@@ -444,26 +508,29 @@ os_uint32_t os_timer_query  ( os_uint8_t task_id, os_int8_t event_id )
     os_uint8_t  timer_id;
 #endif//(OS_TIMER_MAX >= UINT8_MAX)
 #endif
+    os_uint32_t timeout = 0;
 
     OS_ASSERT( task_id < os_task_max &&
                event_id >= 0 &&
                event_id < OS_TASK_EVENT_MAX );
 
+    OS_URGENT_LOCK();
 #ifdef OS_TIMER_USE_HEAP
     p_timer_match = os_timer_event_find( task_id, event_id );
     if( p_timer_match )
     {
-        return p_timer_match->timeout;
+        timeout = p_timer_match->timeout;
     }
 #else
     timer_id = os_timer_event_find( task_id, event_id );
     if( timer_id != OS_TIMER_MAX )
     {
-        return os_timer_list[timer_id].timeout;
+        timeout = os_timer_list[timer_id].timeout;
     }
 #endif
+    OS_URGENT_UNLOCK();
     
-    return 0;
+    return timeout;
 }
 
 #endif // OS_TIMER_EN
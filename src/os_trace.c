@@ -0,0 +1,131 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/* Includes ------------------------------------------------------------------*/
+#include "os.h"
+
+#ifdef OS_TRACE_EN
+
+/* Exported variables --------------------------------------------------------*/
+#ifdef OS_CLOCK_EN
+extern volatile os_uint32_t os_systick;
+#endif
+
+/* Private define ------------------------------------------------------------*/
+#ifndef OS_TRACE_TIME
+#ifndef OS_CLOCK_EN
+#error "OS_TRACE_EN requires OS_CLOCK_EN or OS_TRACE_TIME() in os_portable.h."
+#endif
+#define OS_TRACE_TIME()         os_systick
+#endif
+
+#define OS_TRACE_MASK           (OS_TRACE_SIZE - 1)
+
+#if (OS_TRACE_SIZE & OS_TRACE_MASK) || (OS_TRACE_SIZE > 32768)
+#error "OS_TRACE_SIZE should be a power of 2 and not larger than 32768."
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+OS_ASSERT_SIZE( OS_TRACE_REC_t, 8 );
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static OS_TRACE_REC_t os_trace_buf[OS_TRACE_SIZE];
+static os_uint16_t os_trace_next;
+static os_uint8_t os_trace_wrapped;
+static volatile os_uint8_t os_trace_on = TRUE;
+
+/* Private function prototypes -----------------------------------------------*/
+void __os_trace( os_uint8_t type, os_uint8_t task_id, os_uint16_t arg );
+
+/* Exported function implementations -----------------------------------------*/
+/* recording is on from power on, turn it off to read a stable snapshot, returns the previous state */
+os_uint8_t os_trace_enable( os_uint8_t enable )
+{
+    os_uint8_t prev = os_trace_on;
+
+    os_trace_on = enable;
+    return prev;
+}
+
+void os_trace_clear( void )
+{
+    OS_ENTER_CRITICAL();
+    os_trace_next = 0;
+    os_trace_wrapped = FALSE;
+    OS_EXIT_CRITICAL();
+}
+
+/* records held, at most OS_TRACE_SIZE */
+os_uint16_t os_trace_count( void )
+{
+    return os_trace_wrapped ? OS_TRACE_SIZE : os_trace_next;
+}
+
+/* index 0 is the oldest record, returns OS_ERR_EMPTY past the newest one */
+os_err_t os_trace_get( os_uint16_t index, OS_TRACE_REC_t *p_rec )
+{
+    OS_ASSERT( p_rec != NULL );
+
+    OS_ENTER_CRITICAL();
+    if( index >= os_trace_count() )
+    {
+        OS_EXIT_CRITICAL();
+        return OS_ERR_EMPTY;
+    }
+    if( os_trace_wrapped )
+    {
+        index = ( os_trace_next + index ) & OS_TRACE_MASK;
+    }
+    *p_rec = os_trace_buf[index];
+    OS_EXIT_CRITICAL();
+
+    return OS_ERR_NONE;
+}
+
+/* Private function implementations ------------------------------------------*/
+/* called through OS_TRACE() from task and interrupt context alike */
+void __os_trace( os_uint8_t type, os_uint8_t task_id, os_uint16_t arg )
+{
+    OS_TRACE_REC_t *p_rec;
+#ifdef OS_INT_SAVE
+    os_uint32_t state;
+#endif
+
+    if( !os_trace_on )
+        return;
+
+    /* mask directly, a nested critical section would cost more than the record */
+#ifdef OS_INT_SAVE
+    state = OS_INT_SAVE();
+#else
+    OS_ENTER_CRITICAL();
+#endif
+    p_rec = &os_trace_buf[os_trace_next];
+    os_trace_next = ( os_trace_next + 1 ) & OS_TRACE_MASK;
+    if( os_trace_next == 0 )
+    {
+        os_trace_wrapped = TRUE;
+    }
+    p_rec->time = OS_TRACE_TIME();
+    p_rec->type = type;
+    p_rec->task_id = task_id;
+    p_rec->arg = arg;
+#ifdef OS_INT_SAVE
+    OS_INT_RESTORE( state );
+#else
+    OS_EXIT_CRITICAL();
+#endif
+}
+
+#endif /* OS_TRACE_EN */
+
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
@@ -95,8 +95,11 @@
  * called from within umm_malloc()
  */
 
-#define UMM_CRITICAL_ENTRY()
-#define UMM_CRITICAL_EXIT()
+#include "os.h"
+
+/* the urgent level of PEOS may allocate messages while main() is in here */
+#define UMM_CRITICAL_ENTRY()    OS_URGENT_LOCK()
+#define UMM_CRITICAL_EXIT()     OS_URGENT_UNLOCK()
 
 /*
  * -D UMM_INTEGRITY_CHECK :
@@ -0,0 +1,98 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/*
+ * Replays a recorded load trace through governor_decide() on the host and
+ * prints the clock point it picks for every period.
+ *
+ *   cc -I. -o governor_replay tools/governor_replay.c
+ *   ./governor_replay trace.txt [up target hold backlog_up]
+ *
+ * The trace holds one load period per line, the busy share in permille as
+ * printed by the CLI "load hist" command, optionally followed by the number
+ * of ready tasks and the clock in Hz the period ran at. A load with its
+ * clock is scaled to the point the replay has picked. A load without one,
+ * as "load hist" prints it, was measured at whatever point the board had
+ * picked then and is replayed as it is.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+typedef uint8_t os_uint8_t;
+typedef uint16_t os_uint16_t;
+typedef uint32_t os_uint32_t;
+
+#define GOVERNOR_POLICY_ONLY
+#include "components/governor/governor.c"
+
+/* the STM32L031 board clock points */
+static const os_uint32_t replay_hz[] = { 32000000, 16000000, 4194304, 2097152 };
+
+int main( int argc, char **argv )
+{
+    governor_config_t cfg = { .up = 800, .target = 600, .hold = 3, .backlog_up = 4 };
+    governor_state_t state = { 0 };
+    os_uint8_t points = sizeof(replay_hz) / sizeof(replay_hz[0]);
+    char line[64];
+    unsigned int load;
+    unsigned int backlog;
+    unsigned long hz;
+    unsigned long period = 0;
+    unsigned long busy;
+    FILE *fp;
+
+    if( argc != 2 && argc != 6 )
+    {
+        fprintf( stderr, "usage: %s trace.txt [up target hold backlog_up]\n", argv[0] );
+        return 2;
+    }
+    if( argc == 6 )
+    {
+        cfg.up = (os_uint16_t)atoi( argv[2] );
+        cfg.target = (os_uint16_t)atoi( argv[3] );
+        cfg.hold = (os_uint8_t)atoi( argv[4] );
+        cfg.backlog_up = (os_uint8_t)atoi( argv[5] );
+    }
+
+    fp = fopen( argv[1], "r" );
+    if( fp == NULL )
+    {
+        perror( argv[1] );
+        return 1;
+    }
+
+    printf( "period load backlog point hz\n" );
+    while( fgets( line, sizeof(line), fp ) )
+    {
+        backlog = 0;
+        hz = 0;
+        if( sscanf( line, "%u %u %lu", &load, &backlog, &hz ) < 1 )
+            continue;
+
+        /* the same work takes longer at a slower point, saturating at 100% */
+        if( hz )
+        {
+            busy = (unsigned long)load * ( hz / 1000 ) / ( replay_hz[state.point] / 1000 );
+            load = busy > 1000 ? 1000 : (unsigned int)busy;
+        }
+
+        governor_decide( &cfg, &state, replay_hz, points, (os_uint16_t)load, (os_uint8_t)backlog );
+        printf( "%lu %u %u %u %lu\n", period++, load, backlog, state.point,
+                (unsigned long)replay_hz[state.point] );
+    }
+
+    fclose( fp );
+    return 0;
+}
+
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
@@ -0,0 +1,18 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+#ifndef __BOARD_H__
+#define __BOARD_H__
+
+void os_assert_failed( char *file, os_uint32_t line );
+
+#endif //__BOARD_H__
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
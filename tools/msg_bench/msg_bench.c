@@ -0,0 +1,116 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/*
+ * Host benchmark of os_msg_create() / send / recv / delete, with the message
+ * pools or through umm_malloc. Run both and compare the msgs/s printed.
+ *
+ *   SRC="src/os_msg.c src/os_task.c src/os_critical.c src/umm_malloc/umm_malloc.c"
+ *   cc -O2 -Itools/msg_bench -Iinc -Isrc -I. -DOS_MSG_POOL_EN \
+ *      -o msg_bench_pool tools/msg_bench/msg_bench.c $SRC
+ *   cc -O2 -Itools/msg_bench -Iinc -Isrc -I. \
+ *      -o msg_bench_heap tools/msg_bench/msg_bench.c $SRC
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "os.h"
+
+#define BENCH_ROUNDS        2000000uL
+#define BENCH_DEPTH         6           // messages queued at once
+#define BENCH_FRAGMENTS     40          // heap blocks set up before the run
+
+/* the one task that messages are sent to */
+static void bench_task( os_int8_t event_id ) { (void)event_id; }
+
+static const OS_TASK_t bench_task_array[] = {
+    { .p_task_handler = bench_task },
+};
+static OS_TCB_t bench_tcb_array[1];
+const OS_TASK_t *os_task_list = bench_task_array;
+const os_uint8_t os_task_max = 1;
+OS_TCB_t *os_task_tcb = bench_tcb_array;
+
+os_uint8_t os_get_task_id_self( void )
+{
+    return 0;
+}
+
+void os_assert_failed( char *file, os_uint32_t line )
+{
+    fprintf( stderr, "assert %s:%u\n", file, (unsigned)line );
+    exit( 1 );
+}
+
+extern void __os_msg_init( void );
+
+/* len of the i-th message, mostly CLI sized keys with some larger ones */
+static os_uint16_t bench_len( unsigned long i )
+{
+    static const os_uint16_t lens[] = { 8, 8, 8, 8, 12, 8, 24, 8, 8, 40 };
+    return lens[i % ( sizeof(lens) / sizeof(lens[0]) )];
+}
+
+int main( void )
+{
+    struct timespec t0, t1;
+    unsigned long i;
+    unsigned long d;
+    double sec;
+    void *pmsg;
+    void *p_hold[BENCH_FRAGMENTS];
+
+    umm_init();
+    __os_msg_init();
+
+    /* a heap in use is fragmented, leave every other block of a run free */
+    for( i = 0; i < BENCH_FRAGMENTS; i++ )
+    {
+        p_hold[i] = umm_malloc( 4 + ( i % 5 ) * 6 );
+    }
+    for( i = 0; i < BENCH_FRAGMENTS; i += 2 )
+    {
+        umm_free( p_hold[i] );
+    }
+
+    clock_gettime( CLOCK_MONOTONIC, &t0 );
+    for( i = 0; i < BENCH_ROUNDS; i++ )
+    {
+        for( d = 0; d < BENCH_DEPTH; d++ )
+        {
+            pmsg = os_msg_create( bench_len( i + d ), 0 );
+            if( pmsg == NULL )
+            {
+                fprintf( stderr, "out of memory at round %lu\n", i );
+                return 1;
+            }
+            os_msg_send( pmsg, 0 );
+        }
+        while( ( pmsg = os_msg_recv( 0 ) ) != NULL )
+        {
+            os_msg_delete( pmsg );
+        }
+    }
+    clock_gettime( CLOCK_MONOTONIC, &t1 );
+
+    sec = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+#ifdef OS_MSG_POOL_EN
+    printf( "pool: " );
+#else
+    printf( "heap: " );
+#endif
+    printf( "%.0f msgs/s\n", BENCH_ROUNDS * BENCH_DEPTH / sec );
+
+    return 0;
+}
+
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
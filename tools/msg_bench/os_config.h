@@ -0,0 +1,31 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/*
+ * Host configuration for msg_bench, build with -DOS_MSG_POOL_EN for the
+ * pools or without it for the heap path.
+ */
+#ifndef __OS_CONFIG_H__
+#define __OS_CONFIG_H__
+
+#define OS_MSG_EN
+#define OS_MEM_EN
+#define OS_TASK_EVENT_MAX     32
+#define OS_TASK_MAX           32
+
+#define OS_MSG_POOL_8         8
+#define OS_MSG_POOL_16        4
+#define OS_MSG_POOL_32        4
+#define OS_MSG_POOL_64        0             // as on the L031, 33 to 64 bytes come from the heap
+#define OS_MSG_POOL_128       0
+
+#endif //__OS_CONFIG_H__
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
@@ -0,0 +1,47 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/*
+ * Host port for msg_bench, single threaded so interrupts need no masking.
+ */
+#ifndef __OS_PORTABLE_H__
+#define __OS_PORTABLE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define __IRAM
+#define __XRAM
+#define __FLASH
+#define __STATIC_INLINE             static inline
+#define __PACKED
+#define __packed                    // umm_malloc packs with the IAR keyword
+
+typedef uint8_t     os_uint8_t;
+typedef uint16_t    os_uint16_t;
+typedef uint32_t    os_uint32_t;
+typedef uint64_t    os_uint64_t;
+typedef int8_t      os_int8_t;
+typedef int16_t     os_int16_t;
+typedef int32_t     os_int32_t;
+typedef float       os_fpt32_t;
+typedef double      os_fpt64_t;
+typedef size_t      os_size_t;
+
+#define OS_INT_SAVE()               0u
+#define OS_INT_RESTORE(state)       ((void)(state))
+#define os_memset(ptr, val, len)    memset(ptr, val, len)
+#define os_strcmp(s1, s2)           strcmp(s1, s2)
+#define os_strlen(s)                strlen(s)
+
+#endif //__OS_PORTABLE_H__
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
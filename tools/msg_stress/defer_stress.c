@@ -0,0 +1,156 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/*
+ * Host stress test of the deferred work queues. One producer thread per
+ * queue stands in for the interrupts of one priority, the main thread plays
+ * the scheduler and drains the queues. Each item carries its queue and
+ * sequence number in the argument and is deferred to one of two functions by
+ * the parity of the sequence, the test fails on a lost, duplicated,
+ * reordered or torn item. Producers retry an item refused as full.
+ *
+ *   cc -O2 -pthread -Itools/msg_stress -Itools/msg_bench -Iinc -Isrc -I. \
+ *      -DOS_DEFER_EN -DOS_DEFER_PRIO_MAX=4 -DOS_DEFER_QUEUE_SIZE=8 \
+ *      -o defer_stress tools/msg_stress/defer_stress.c tools/msg_stress/stress_port.c src/os_defer.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include "os.h"
+
+#define STRESS_ITEMS        2500000uL   // per queue
+#define STRESS_SEQ_MASK     0x00FFFFFFuL
+
+static volatile int stress_done;
+static unsigned long stress_full[OS_DEFER_PRIO_MAX];
+static unsigned long stress_next[OS_DEFER_PRIO_MAX];
+static unsigned long stress_received;
+
+extern void __os_defer_init( void );
+extern void __os_defer_process( void );
+extern os_uint8_t __os_defer_pending( void );
+
+static void stress_item( os_uint32_t arg, os_uint32_t parity )
+{
+    os_uint32_t prio = arg >> 24;
+    os_uint32_t seq = arg & STRESS_SEQ_MASK;
+
+    if( prio >= OS_DEFER_PRIO_MAX || ( seq & 1 ) != parity )
+    {
+        fprintf( stderr, "FAIL: torn item %08lx\n", (unsigned long)arg );
+        exit( 1 );
+    }
+    /* each queue runs its items once and in order */
+    if( seq != stress_next[prio] )
+    {
+        fprintf( stderr, "FAIL: queue %u seq %lu, expected %lu\n",
+                 (unsigned)prio, (unsigned long)seq, stress_next[prio] );
+        exit( 1 );
+    }
+    stress_next[prio]++;
+    stress_received++;
+}
+
+static void stress_even( os_uint32_t arg )
+{
+    stress_item( arg, 0 );
+}
+
+static void stress_odd( os_uint32_t arg )
+{
+    stress_item( arg, 1 );
+}
+
+static void *stress_producer( void *arg )
+{
+    os_uint8_t prio = (os_uint8_t)(size_t)arg;
+    unsigned long i;
+
+    for( i = 0; i < STRESS_ITEMS; i++ )
+    {
+        while( os_defer( prio, ( i & 1 ) ? stress_odd : stress_even,
+                         ( (os_uint32_t)prio << 24 ) | (os_uint32_t)i ) == OS_ERR_FULL )
+        {
+            stress_full[prio]++;
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+static void *stress_reaper( void *arg )
+{
+    pthread_t *threads = arg;
+    int i;
+
+    for( i = 0; i < OS_DEFER_PRIO_MAX; i++ )
+    {
+        pthread_join( threads[i], NULL );
+    }
+    __atomic_store_n( &stress_done, 1, __ATOMIC_RELEASE );
+
+    return NULL;
+}
+
+int main( void )
+{
+    pthread_t threads[OS_DEFER_PRIO_MAX];
+    pthread_t reaper;
+    unsigned long full = 0;
+    int done;
+    int i;
+
+    __os_defer_init();
+
+    for( i = 0; i < OS_DEFER_PRIO_MAX; i++ )
+    {
+        pthread_create( &threads[i], NULL, stress_producer, (void *)(size_t)i );
+    }
+    pthread_create( &reaper, NULL, stress_reaper, threads );
+
+    /* one more pass after the producers are gone drains what they left */
+    do
+    {
+        done = __atomic_load_n( &stress_done, __ATOMIC_ACQUIRE );
+        if( !__os_defer_pending() )
+        {
+            sched_yield();
+            continue;
+        }
+        __os_defer_process();
+    } while( !done );
+    __os_defer_process();
+    pthread_join( reaper, NULL );
+
+    if( __os_defer_pending() )
+    {
+        fprintf( stderr, "FAIL: items left queued\n" );
+        return 1;
+    }
+    if( stress_received != OS_DEFER_PRIO_MAX * STRESS_ITEMS )
+    {
+        fprintf( stderr, "FAIL: %lu of %lu items run\n", stress_received, OS_DEFER_PRIO_MAX * STRESS_ITEMS );
+        return 1;
+    }
+    for( i = 0; i < OS_DEFER_PRIO_MAX; i++ )
+    {
+        full += stress_full[i];
+    }
+
+    printf( "ok: %lu items from %d queues of %d, %lu refused as full\n",
+            stress_received, OS_DEFER_PRIO_MAX, OS_DEFER_QUEUE_SIZE, full );
+    return 0;
+}
+
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
@@ -0,0 +1,191 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/*
+ * Host stress test of the per-task message queues. Producer threads stand in
+ * for interrupts and tasks sending concurrently, one consumer thread plays
+ * the scheduler: it only receives while the task's ready bit is set. Every
+ * message carries its producer and sequence number, the test fails on a lost,
+ * duplicated or reordered message, on a lost wakeup and on a queue deeper
+ * than its limit. Producers retry a send refused as full.
+ *
+ *   SRC="src/os_msg.c src/os_task.c src/os_critical.c src/umm_malloc/umm_malloc.c"
+ *   cc -O2 -pthread -Itools/msg_stress -Itools/msg_bench -Iinc -Isrc -I. \
+ *      -o msg_stress tools/msg_stress/msg_stress.c tools/msg_stress/stress_port.c $SRC
+ */
+
+#define _GNU_SOURCE                 // pthread_tryjoin_np()
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include "os.h"
+
+#define STRESS_PRODUCERS    4
+#define STRESS_MSGS         1000000uL   // per producer
+#define STRESS_URGENT       7           // every n-th message is urgent
+
+typedef struct stress_msg {
+    OS_MSG_t hdr;
+    os_uint32_t producer;
+    os_uint32_t seq;
+    os_uint8_t urgent;
+} STRESS_MSG_t;
+
+/* the one task that messages are sent to */
+static void stress_task( os_int8_t event_id ) { (void)event_id; }
+
+static const OS_TASK_t stress_task_array[] = {
+    { .p_task_handler = stress_task },
+};
+static OS_TCB_t stress_tcb_array[1];
+const OS_TASK_t *os_task_list = stress_task_array;
+const os_uint8_t os_task_max = 1;
+OS_TCB_t *os_task_tcb = stress_tcb_array;
+
+static volatile int stress_done;
+static unsigned long stress_full[STRESS_PRODUCERS];
+
+extern void __os_msg_init( void );
+extern os_uint8_t __os_msg_pending( os_uint8_t task_id );
+extern os_uint8_t __os_task_ready_get( void );
+
+os_uint8_t os_get_task_id_self( void )
+{
+    return 0;
+}
+
+static void *stress_producer( void *arg )
+{
+    os_uint32_t producer = (os_uint32_t)(size_t)arg;
+    STRESS_MSG_t *p;
+    unsigned long i;
+
+    for( i = 0; i < STRESS_MSGS; i++ )
+    {
+        p = malloc( sizeof(*p) );
+        if( p == NULL )
+        {
+            fprintf( stderr, "out of memory\n" );
+            exit( 1 );
+        }
+        p->hdr.len = sizeof(*p) - sizeof(OS_MSG_t);
+        p->hdr.type = 0;
+        p->producer = producer;
+        p->seq = (os_uint32_t)i;
+        p->urgent = ( i % STRESS_URGENT ) == 0;
+        while( ( p->urgent ? os_msg_send_urgent( &p->producer, 0 )
+                           : os_msg_send( &p->producer, 0 ) ) == OS_ERR_FULL )
+        {
+            stress_full[producer]++;
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+int main( void )
+{
+    pthread_t threads[STRESS_PRODUCERS];
+    OS_MSG_STAT_t stat;
+    unsigned long full = 0;
+    long next[STRESS_PRODUCERS][2];     // next sequence expected, normal and urgent
+    unsigned long received = 0;
+    unsigned long spins = 0;
+    int joined = 0;
+    STRESS_MSG_t *p;
+    void *pmsg;
+    int done;
+    int i;
+
+    __os_msg_init();
+
+    for( i = 0; i < STRESS_PRODUCERS; i++ )
+    {
+        next[i][0] = -1;
+        next[i][1] = -1;
+        pthread_create( &threads[i], NULL, stress_producer, (void *)(size_t)i );
+    }
+
+    /* idle spins reap the producers, the ready bit must be clear once all are gone */
+    for( ;; )
+    {
+        done = __atomic_load_n( &stress_done, __ATOMIC_ACQUIRE );
+        if( __os_task_ready_get() != 0 )
+        {
+            if( done )
+                break;
+            sched_yield();
+            if( ++spins == 1000 )
+            {
+                spins = 0;
+                while( joined < STRESS_PRODUCERS && pthread_tryjoin_np( threads[joined], NULL ) == 0 )
+                {
+                    joined++;
+                }
+                if( joined == STRESS_PRODUCERS )
+                {
+                    __atomic_store_n( &stress_done, 1, __ATOMIC_RELEASE );
+                }
+            }
+            continue;
+        }
+
+        while( ( pmsg = os_msg_recv( 0 ) ) != NULL )
+        {
+            p = (STRESS_MSG_t *)( (os_uint8_t *)pmsg - sizeof(OS_MSG_t) );
+            if( p->producer >= STRESS_PRODUCERS )
+            {
+                fprintf( stderr, "FAIL: corrupt message\n" );
+                return 1;
+            }
+            /* sequence numbers rise within each producer and queue */
+            if( (long)p->seq <= next[p->producer][p->urgent] )
+            {
+                fprintf( stderr, "FAIL: producer %u seq %u after %ld\n",
+                         (unsigned)p->producer, (unsigned)p->seq, next[p->producer][p->urgent] );
+                return 1;
+            }
+            next[p->producer][p->urgent] = p->seq;
+            received++;
+            free( p );
+        }
+    }
+
+    if( __os_msg_pending( 0 ) || os_msg_recv( 0 ) != NULL )
+    {
+        fprintf( stderr, "FAIL: message left queued with the ready bit clear\n" );
+        return 1;
+    }
+    if( received != STRESS_PRODUCERS * STRESS_MSGS )
+    {
+        fprintf( stderr, "FAIL: %lu of %lu messages received\n", received, STRESS_PRODUCERS * STRESS_MSGS );
+        return 1;
+    }
+
+    os_msg_stat_get( 0, &stat );
+    if( stat.count != 0 || stat.count_max > stat.depth )
+    {
+        fprintf( stderr, "FAIL: count %u, high-water %u of depth %u\n", stat.count, stat.count_max, stat.depth );
+        return 1;
+    }
+    for( i = 0; i < STRESS_PRODUCERS; i++ )
+    {
+        full += stress_full[i];
+    }
+
+    printf( "ok: %lu messages from %d producers, %lu sends refused as full, high-water %u\n",
+            received, STRESS_PRODUCERS, full, stat.count_max );
+    return 0;
+}
+
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
@@ -0,0 +1,61 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/*
+ * Host port for the stress tests. Threads stand in for the interrupts and
+ * the scheduler, so OS_INT_SAVE() takes one lock shared by all of them and
+ * critical sections exclude each other as on a single core. A thread outside
+ * a critical section is not held off the way main() is while an interrupt
+ * runs, the tests see more interleavings than the target can.
+ *
+ * Outside the critical sections the kernel leans on two orderings: stores
+ * made before an atomic or OS_MEMORY_BARRIER() are seen before the stores
+ * after it (a message before its link, a deferred item before the new tail),
+ * and plain loads are not reordered with each other (the ready bit before
+ * the queue it flags). The builtins give the first on any host, the second
+ * is given by a single core and by total store order, run them on x86.
+ */
+#ifndef __OS_PORTABLE_H__
+#define __OS_PORTABLE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define __IRAM
+#define __XRAM
+#define __FLASH
+#define __STATIC_INLINE             static inline
+#define __PACKED
+#define __packed                    // umm_malloc packs with the IAR keyword
+
+typedef uint8_t     os_uint8_t;
+typedef uint16_t    os_uint16_t;
+typedef uint32_t    os_uint32_t;
+typedef uint64_t    os_uint64_t;
+typedef int8_t      os_int8_t;
+typedef int16_t     os_int16_t;
+typedef int32_t     os_int32_t;
+typedef float       os_fpt32_t;
+typedef double      os_fpt64_t;
+typedef size_t      os_size_t;
+
+os_uint32_t stress_int_save( void );
+void stress_int_restore( os_uint32_t state );
+
+#define OS_INT_SAVE()               stress_int_save()
+#define OS_INT_RESTORE(state)       stress_int_restore(state)
+#define os_memset(ptr, val, len)    memset(ptr, val, len)
+#define os_strcmp(s1, s2)           strcmp(s1, s2)
+#define os_strlen(s)                strlen(s)
+
+#endif //__OS_PORTABLE_H__
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
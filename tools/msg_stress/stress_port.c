@@ -0,0 +1,51 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/*
+ * Interrupt masking and assert for the stress tests, see os_portable.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "os.h"
+
+static pthread_mutex_t stress_int_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread os_uint32_t stress_int_masked;  // this thread holds the lock
+
+/* returns the mask it found, like PRIMASK, only an unmasked caller locks */
+os_uint32_t stress_int_save( void )
+{
+    if( stress_int_masked )
+    {
+        return 1;
+    }
+    pthread_mutex_lock( &stress_int_lock );
+    stress_int_masked = 1;
+    return 0;
+}
+
+void stress_int_restore( os_uint32_t state )
+{
+    if( !state )
+    {
+        stress_int_masked = 0;
+        pthread_mutex_unlock( &stress_int_lock );
+    }
+}
+
+void os_assert_failed( char *file, os_uint32_t line )
+{
+    fprintf( stderr, "assert %s:%u\n", file, (unsigned)line );
+    exit( 1 );
+}
+
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
@@ -0,0 +1,122 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/*
+ * Simulated board shared by the scheduler simulations. sim_tick() stands in
+ * for SysTick_Handler. os_board_sleep() follows the STM32L031 port: it sleeps
+ * at most SIM_SLEEP_MAX ticks, the handler counts the last tick of a full
+ * sleep, and an interrupt may end it early. The interrupt is a simulation
+ * hook, raised once in one_in sleeps and idle ticks.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "os.h"
+
+#define SIM_SLEEP_MAX       524             // 24-bit SysTick at 32 MHz, 1 ms ticks
+#define SIM_CYCLES_PER_TICK 32000
+
+extern volatile os_uint32_t os_systick;
+
+os_uint32_t sim_time;
+os_uint32_t sim_sleeps;
+os_uint32_t sim_slept;
+
+static void (*sim_irq)( void );
+static os_uint32_t sim_irq_one_in;
+static os_uint32_t sim_seed = 1;
+
+/* xorshift32, the same sequence on every host, *p_seed must not be 0 */
+os_uint32_t sim_rand( os_uint32_t *p_seed )
+{
+    *p_seed ^= *p_seed << 13;
+    *p_seed ^= *p_seed >> 17;
+    *p_seed ^= *p_seed << 5;
+    return *p_seed;
+}
+
+static os_uint8_t sim_irq_due( void )
+{
+    return sim_irq != NULL && ( sim_rand( &sim_seed ) % sim_irq_one_in ) == 0;
+}
+
+void sim_tick( void )
+{
+    sim_time++;
+    os_systick++;
+}
+
+void sim_irq_hook( void (*p_fxn)( void ), os_uint32_t one_in )
+{
+    sim_irq = p_fxn;
+    sim_irq_one_in = one_in;
+}
+
+void os_board_init( void )
+{
+}
+
+/* WFI until SysTick */
+void os_board_idle( void )
+{
+    sim_tick();
+    if( sim_irq_due() )
+    {
+        sim_irq();
+    }
+}
+
+#ifdef OS_TICKLESS_EN
+os_uint32_t os_board_sleep( os_uint32_t tick )
+{
+    os_uint32_t elapsed;
+
+    if( tick > SIM_SLEEP_MAX )
+    {
+        tick = SIM_SLEEP_MAX;
+    }
+    if( tick <= 1 )
+    {
+        os_board_idle();
+        return 0;
+    }
+
+    sim_sleeps++;
+    if( sim_irq_due() )
+    {
+        /* woken early, the ticks passed are not counted by the handler */
+        elapsed = sim_rand( &sim_seed ) % tick;
+        sim_time += elapsed;
+        sim_slept += elapsed;
+        sim_irq();
+        return elapsed;
+    }
+
+    /* slept the whole period, the handler counts the last tick */
+    sim_time += tick - 1;
+    sim_slept += tick;
+    sim_tick();
+    return tick - 1;
+}
+#endif
+
+os_uint32_t os_board_cycles( void )
+{
+    return sim_time * SIM_CYCLES_PER_TICK;
+}
+
+void os_assert_failed( char *file, os_uint32_t line )
+{
+    fprintf( stderr, "assert %s:%u\n", file, (unsigned)line );
+    exit( 1 );
+}
+
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
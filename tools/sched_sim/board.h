@@ -0,0 +1,43 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/*
+ * Simulated board for the scheduler simulations. Time only moves when the
+ * kernel idles or sleeps, or when a simulation calls sim_tick(), so every
+ * run is repeatable.
+ */
+#ifndef __BOARD_H__
+#define __BOARD_H__
+
+void os_board_init( void );
+void os_board_idle( void );
+#ifdef OS_TICKLESS_EN
+os_uint32_t os_board_sleep( os_uint32_t tick );
+#endif
+os_uint32_t os_board_cycles( void );
+void os_assert_failed( char *file, os_uint32_t line );
+
+extern os_uint32_t sim_time;                // ticks really passed
+extern os_uint32_t sim_sleeps;              // os_board_sleep() calls that slept
+extern os_uint32_t sim_slept;               // ticks those slept
+void sim_tick( void );
+void sim_irq_hook( void (*p_fxn)( void ), os_uint32_t one_in );
+os_uint32_t sim_rand( os_uint32_t *p_seed );
+
+/* the kernel task table and its TCBs, from the OS_TASK_t array of a simulation */
+#define SIM_TASK_TABLE(array)                                               \
+    static OS_TCB_t sim_tcb_array[sizeof(array) / sizeof((array)[0])];     \
+    const OS_TASK_t *os_task_list = (array);                                \
+    const os_uint8_t os_task_max = sizeof(array) / sizeof((array)[0]);     \
+    OS_TCB_t *os_task_tcb = sim_tcb_array
+
+#endif //__BOARD_H__
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
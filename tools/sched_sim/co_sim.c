@@ -0,0 +1,190 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/*
+ * Coroutine tasks interleaved on the simulated board. Each of SIM_TASKS
+ * coroutines runs SIM_ROUNDS rounds of:
+ *  - os_await_timer() for a random while, the timer must fire on its tick.
+ *    With fewer timers than tasks some starts fail, and the await must
+ *    return the error at once.
+ *  - send a message to the peer of the round, every task gets one per round
+ *  - os_await_msg(), then wake its sender through a flag and an event
+ *  - await that wakeup from its own peer
+ * Messages from faster peers arrive while a coroutine awaits its timer or
+ * its wakeup, they must not hold up those events. A dispatch count far
+ * beyond the work to do fails the run as a livelock.
+ *
+ *   SRC="src/os_sys.c src/os_task.c src/os_clock.c src/os_timer.c src/os_critical.c \
+ *        src/os_msg.c src/umm_malloc/umm_malloc.c"
+ *   cc -O2 -Itools/sched_sim -Itools/msg_bench -Iinc -Isrc -I. \
+ *      -DOS_MSG_EN -DOS_MEM_EN -DOS_CO_EN -DOS_TASK_MAX=200 -DOS_TIMER_MAX=128 \
+ *      -o co_sim tools/sched_sim/co_sim.c tools/sched_sim/board.c $SRC
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "os.h"
+
+#define SIM_TASKS           200
+#define SIM_ROUNDS          200
+#define SIM_DISPATCH_MAX    ( 20uL * SIM_TASKS * SIM_ROUNDS )
+
+#define CO_EVT_TIMER        0
+#define CO_EVT_WAKE         1
+#define CO_EVT_NEVER        2
+
+typedef struct sim_msg {
+    os_uint8_t from;
+    os_uint16_t round;
+} SIM_MSG_t;
+
+static os_uint16_t sim_round[SIM_TASKS];
+static os_uint32_t sim_due[SIM_TASKS];
+static os_uint16_t sim_got[SIM_TASKS];      // messages taken in the current round
+static os_uint16_t sim_woken[SIM_TASKS];    // wakeups from the peers, by round
+static os_uint32_t sim_dispatches;
+static os_uint32_t sim_timer_errs;
+static os_uint32_t sim_msgs;
+static os_uint32_t sim_early_msgs;          // taken by a coroutine a round behind its sender
+static os_uint16_t sim_done;
+static os_uint32_t sim_seed = 5;
+
+static void sim_fail( os_uint8_t task_id, const char *what )
+{
+    fprintf( stderr, "FAIL: task %u round %u %s at tick %lu\n", (unsigned)task_id,
+             (unsigned)sim_round[task_id], what, (unsigned long)sim_time );
+    exit( 1 );
+}
+
+/* peer of a round, one step further round by round so every task gets one message per round */
+static os_uint8_t sim_peer( os_uint8_t task_id, os_uint16_t round )
+{
+    return (os_uint8_t)( ( task_id + 1 + round % ( SIM_TASKS - 1 ) ) % SIM_TASKS );
+}
+
+static void sim_finish( void )
+{
+    os_uint8_t task_id;
+
+    for( task_id = 0; task_id < SIM_TASKS; task_id++ )
+    {
+        if( os_msg_recv( task_id ) != NULL )
+        {
+            sim_fail( task_id, "left a message queued" );
+        }
+    }
+    printf( "%u coroutines, %lu rounds in %lu ticks, %lu dispatches, %lu messages "
+            "(%lu ahead of their taker), %lu timer starts refused\n",
+            (unsigned)SIM_TASKS, (unsigned long)SIM_TASKS * SIM_ROUNDS, (unsigned long)sim_time,
+            (unsigned long)sim_dispatches, (unsigned long)sim_msgs, (unsigned long)sim_early_msgs,
+            (unsigned long)sim_timer_errs );
+    if( sim_msgs != (os_uint32_t)SIM_TASKS * SIM_ROUNDS )
+    {
+        fprintf( stderr, "FAIL: %lu messages taken\n", (unsigned long)sim_msgs );
+        exit( 1 );
+    }
+    printf( "ok\n" );
+    exit( 0 );
+}
+
+static void co_task( os_int8_t event_id )
+{
+    os_uint8_t task_id = os_get_task_id_self();
+    SIM_MSG_t *p_msg;
+    os_uint32_t tick;
+    os_uint32_t now;
+    os_err_t err;
+
+    if( ++sim_dispatches > SIM_DISPATCH_MAX )
+    {
+        sim_fail( task_id, "livelocked" );
+    }
+
+    OS_CO_BEGIN( event_id );
+    while( sim_round[task_id] < SIM_ROUNDS )
+    {
+        tick = 1 + sim_rand( &sim_seed ) % 50;
+        sim_due[task_id] = sim_time + tick;
+        now = sim_time;
+        os_await_timer( CO_EVT_TIMER, tick, err );
+        if( err == OS_ERR_NONE )
+        {
+            if( sim_time != sim_due[task_id] )
+            {
+                sim_fail( task_id, "timer off its tick" );
+            }
+        }
+        else if( sim_time != now )
+        {
+            sim_fail( task_id, "waited on a timer it could not start" );
+        }
+        else
+        {
+            sim_timer_errs++;
+        }
+
+        p_msg = os_msg_create( sizeof(SIM_MSG_t), 0 );
+        if( p_msg == NULL )
+        {
+            sim_fail( task_id, "out of memory" );
+        }
+        p_msg->from = task_id;
+        p_msg->round = sim_round[task_id];
+        if( os_msg_send( p_msg, sim_peer( task_id, sim_round[task_id] ) ) != OS_ERR_NONE )
+        {
+            sim_fail( task_id, "send refused" );
+        }
+
+        /* one message a round, a faster peer's next one may already be queued */
+        sim_got[task_id] = 0;
+        while( sim_got[task_id] == 0 )
+        {
+            os_await_msg( p_msg );
+            if( p_msg->round > sim_round[task_id] )
+            {
+                sim_early_msgs++;
+            }
+            sim_woken[p_msg->from]++;
+            os_task_set_event( p_msg->from, CO_EVT_WAKE );
+            os_msg_delete( p_msg );
+            sim_msgs++;
+            sim_got[task_id]++;
+        }
+
+        /* the wakeup may have come while awaiting the message */
+        if( sim_woken[task_id] <= sim_round[task_id] )
+        {
+            OS_CO_WAIT_UNTIL( sim_woken[task_id] > sim_round[task_id] );
+        }
+        sim_round[task_id]++;
+    }
+
+    if( ++sim_done == SIM_TASKS )
+    {
+        sim_finish();
+    }
+    os_await_event( CO_EVT_NEVER );
+    OS_CO_END();
+}
+
+static void co_init( os_uint8_t task_id )
+{
+    /* the first dispatch starts the coroutine */
+    os_task_set_event( task_id, CO_EVT_WAKE );
+    sim_woken[task_id] = 0;
+}
+
+static const OS_TASK_t sim_task_array[SIM_TASKS] = {
+    [0 ... SIM_TASKS - 1] = { .p_task_init = co_init, .p_task_handler = co_task, .co = TRUE },
+};
+SIM_TASK_TABLE( sim_task_array );
+
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
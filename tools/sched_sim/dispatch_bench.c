@@ -0,0 +1,180 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/*
+ * Dispatch cost of the ready bitmap against the linear scan it replaced, at
+ * BENCH_TASKS tasks. One event is pending at a time, each handler sets the
+ * next one on a random task and event. The task init first runs the old main
+ * loop, scanning every task and then every event bit, then the real
+ * scheduler runs the same sequence. Both must dispatch the same (task,
+ * event) pairs. Build it once per task count, e.g. 4, 16 and 64:
+ *
+ *   SRC="src/os_sys.c src/os_task.c src/os_clock.c src/os_timer.c src/os_critical.c"
+ *   cc -O2 -Itools/sched_sim -Itools/msg_bench -Iinc -Isrc -I. -DBENCH_TASKS=16 \
+ *      -o dispatch_bench tools/sched_sim/dispatch_bench.c tools/sched_sim/board.c $SRC
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "os.h"
+
+#ifndef BENCH_TASKS
+#define BENCH_TASKS         16
+#endif
+#define BENCH_DISPATCH      10000000uL
+
+#if BENCH_TASKS > OS_TASK_MAX
+#error "BENCH_TASKS should not be larger than OS_TASK_MAX."
+#endif
+
+extern os_uint32_t __os_clock_update( void );
+extern void __os_timer_process( os_uint32_t elapsed_tick );
+
+static os_uint8_t bench_linear = TRUE;
+static os_uint32_t bench_count;
+static os_uint32_t bench_sum[2];
+static os_uint32_t bench_seed;
+static double bench_ns[2];
+static struct timespec bench_start;
+
+/* task events of the old scheduler, kept in the TCB before the bitmap */
+static os_event_t lin_event[BENCH_TASKS];
+static os_uint8_t lin_task_id;
+
+static double bench_elapsed( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( now.tv_sec - bench_start.tv_sec ) * 1e9 + ( now.tv_nsec - bench_start.tv_nsec );
+}
+
+static void bench_next( void )
+{
+    os_uint32_t r = sim_rand( &bench_seed );
+    os_uint8_t task_id = (os_uint8_t)( r % BENCH_TASKS );
+    os_int8_t event_id = (os_int8_t)( ( r >> 8 ) % OS_TASK_EVENT_MAX );
+
+    if( bench_linear )
+    {
+        OS_ENTER_CRITICAL();
+        lin_event[task_id] |= BV( event_id );
+        OS_EXIT_CRITICAL();
+    }
+    else
+    {
+        os_task_set_event( task_id, event_id );
+    }
+}
+
+static void bench_finish( void )
+{
+    printf( "%u tasks: linear scan %.1f ns, bitmap %.1f ns per dispatch\n",
+            (unsigned)BENCH_TASKS, bench_ns[0] / BENCH_DISPATCH, bench_ns[1] / BENCH_DISPATCH );
+    if( bench_sum[0] != bench_sum[1] )
+    {
+        fprintf( stderr, "FAIL: the two schedulers dispatched different events\n" );
+        exit( 1 );
+    }
+    exit( 0 );
+}
+
+static void bench_task( os_int8_t event_id )
+{
+    os_uint8_t task_id = bench_linear ? lin_task_id : os_get_task_id_self();
+
+    bench_sum[!bench_linear] = bench_sum[!bench_linear] * 31 + task_id * 32 + event_id;
+    if( ++bench_count == BENCH_DISPATCH )
+    {
+        bench_ns[!bench_linear] = bench_elapsed();
+        if( !bench_linear )
+        {
+            bench_finish();
+        }
+        return;
+    }
+    bench_next();
+}
+
+/* the main loop as it was, minus the messages */
+static void bench_linear_run( void )
+{
+    os_uint8_t task_id;
+    os_int8_t event_id;
+    os_event_t event;
+
+    while( bench_count < BENCH_DISPATCH )
+    {
+        __os_timer_process( __os_clock_update() );
+
+        for( task_id = 0; task_id < BENCH_TASKS; task_id++ )
+        {
+            OS_ENTER_CRITICAL();
+            event = lin_event[task_id];
+            OS_EXIT_CRITICAL();
+
+            if( event )
+            {
+                event_id = 0;
+                while( (event & BV(event_id)) == 0 )
+                {
+                    event_id++;
+                }
+                event = BV( event_id );
+
+                OS_ENTER_CRITICAL();
+                if( lin_event[task_id] & event )
+                {
+                    lin_event[task_id] &= ~event;
+                    OS_EXIT_CRITICAL();
+                    lin_task_id = task_id;
+                    bench_task( event_id );
+                }
+                else
+                {
+                    OS_EXIT_CRITICAL();
+                }
+                break;
+            }
+        }
+
+        if( task_id == BENCH_TASKS )
+        {
+            os_board_idle();
+        }
+    }
+}
+
+static void bench_init( os_uint8_t task_id )
+{
+    if( task_id != BENCH_TASKS - 1 )
+        return;
+
+    bench_seed = 7;
+    bench_next();
+    clock_gettime( CLOCK_MONOTONIC, &bench_start );
+    bench_linear_run();
+
+    /* the same sequence again, through the real scheduler */
+    bench_linear = FALSE;
+    bench_count = 0;
+    bench_seed = 7;
+    bench_next();
+    clock_gettime( CLOCK_MONOTONIC, &bench_start );
+}
+
+static const OS_TASK_t sim_task_array[BENCH_TASKS] = {
+    [0 ... BENCH_TASKS - 1] = { .p_task_init = bench_init, .p_task_handler = bench_task },
+};
+SIM_TASK_TABLE( sim_task_array );
+
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
@@ -0,0 +1,135 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/*
+ * Events per second through the real scheduler, one event per handler call
+ * against the whole pending mask per call. BENCH_TASKS tasks pass a burst of
+ * BENCH_BURST events around a ring: the task that has taken all of its burst
+ * sets a new one on the next task. Build it three ways, the first is the
+ * scheduler without the mask handler compiled in:
+ *
+ *   SRC="src/os_sys.c src/os_task.c src/os_clock.c src/os_timer.c src/os_critical.c"
+ *   CC="cc -O2 -Itools/sched_sim -Itools/msg_bench -Iinc -Isrc -I."
+ *   $CC -o event_bench tools/sched_sim/event_bench.c tools/sched_sim/board.c $SRC
+ *   $CC -DOS_EVENT_MASK_EN -o event_bench_one tools/sched_sim/event_bench.c tools/sched_sim/board.c $SRC
+ *   $CC -DOS_EVENT_MASK_EN -DBENCH_MASK -o event_bench_mask tools/sched_sim/event_bench.c tools/sched_sim/board.c $SRC
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "os.h"
+
+#define BENCH_TASKS         8
+#define BENCH_BURST         8
+#define BENCH_EVENTS        20000000uL
+#define BENCH_BURST_MASK    ( (os_event_t)BV( BENCH_BURST ) - 1 )
+
+#if defined(BENCH_MASK) && !defined(OS_EVENT_MASK_EN)
+#error "BENCH_MASK needs OS_EVENT_MASK_EN."
+#endif
+
+static os_uint32_t bench_events;
+static os_uint32_t bench_calls;
+static os_event_t bench_taken[BENCH_TASKS];
+static struct timespec bench_start;
+
+static void bench_finish( void )
+{
+    struct timespec now;
+    double sec;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    sec = ( now.tv_sec - bench_start.tv_sec ) + ( now.tv_nsec - bench_start.tv_nsec ) * 1e-9;
+    printf( "%s: %lu events in %lu handler calls, %.2f s, %.1f M events/s\n",
+#ifdef BENCH_MASK
+            "mask handler",
+#elif defined(OS_EVENT_MASK_EN)
+            "event handler, mask compiled in",
+#else
+            "event handler",
+#endif
+            (unsigned long)bench_events, (unsigned long)bench_calls, sec, bench_events / sec * 1e-6 );
+    exit( 0 );
+}
+
+/* the burst is all taken, hand a new one to the next task */
+static void bench_burst( os_uint8_t task_id )
+{
+    os_int8_t event_id;
+
+    if( bench_events >= BENCH_EVENTS )
+    {
+        bench_finish();
+    }
+    bench_taken[task_id] = 0;
+    task_id = ( task_id + 1 ) % BENCH_TASKS;
+    for( event_id = 0; event_id < BENCH_BURST; event_id++ )
+    {
+        os_task_set_event( task_id, event_id );
+    }
+}
+
+static void bench_take( os_event_t events )
+{
+    os_uint8_t task_id = os_get_task_id_self();
+
+    bench_calls++;
+    if( bench_taken[task_id] & events )
+    {
+        fprintf( stderr, "FAIL: task %u got events %08lx twice\n", (unsigned)task_id, (unsigned long)events );
+        exit( 1 );
+    }
+    bench_taken[task_id] |= events;
+    while( events )
+    {
+        bench_events++;
+        events &= events - 1;
+    }
+    if( bench_taken[task_id] == BENCH_BURST_MASK )
+    {
+        bench_burst( task_id );
+    }
+}
+
+static void bench_task( os_int8_t event_id )
+{
+    bench_take( (os_event_t)BV( event_id ) );
+}
+
+#ifdef BENCH_MASK
+static void bench_task_mask( os_event_t events )
+{
+    bench_take( events );
+}
+#endif
+
+static void bench_init( os_uint8_t task_id )
+{
+    if( task_id == BENCH_TASKS - 1 )
+    {
+        bench_burst( task_id );
+        clock_gettime( CLOCK_MONOTONIC, &bench_start );
+    }
+}
+
+static const OS_TASK_t sim_task_array[BENCH_TASKS] = {
+#ifdef BENCH_MASK
+#define BENCH_TASK  { .p_task_init = bench_init, .p_task_handler = bench_task, .p_task_handler_mask = bench_task_mask }
+#else
+#define BENCH_TASK  { .p_task_init = bench_init, .p_task_handler = bench_task }
+#endif
+    BENCH_TASK, BENCH_TASK, BENCH_TASK, BENCH_TASK,
+    BENCH_TASK, BENCH_TASK, BENCH_TASK, BENCH_TASK,
+};
+SIM_TASK_TABLE( sim_task_array );
+
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
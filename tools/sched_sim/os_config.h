@@ -0,0 +1,34 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/*
+ * Host configuration for the scheduler simulations. Each one adds the
+ * features it exercises with -D, e.g. -DOS_TICKLESS_EN.
+ */
+#ifndef __OS_CONFIG_H__
+#define __OS_CONFIG_H__
+
+#define OS_CLOCK_EN
+#define OS_TIMER_EN
+#ifndef OS_TIMER_MAX
+#define OS_TIMER_MAX          16
+#endif
+#define OS_TASK_EVENT_MAX     32
+#ifndef OS_TASK_MAX
+#define OS_TASK_MAX           64
+#endif
+#ifdef OS_DEFER_EN
+#define OS_DEFER_PRIO_MAX     1
+#define OS_DEFER_QUEUE_SIZE   8
+#endif
+
+#endif //__OS_CONFIG_H__
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
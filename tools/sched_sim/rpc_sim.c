@@ -0,0 +1,203 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/*
+ * os_rpc_call() timing on the simulated board with tickless idle. A client
+ * makes calls with a 100 tick timeout, idling a random while between them.
+ * The server answers each one in one of four ways: at once, 40 ticks later,
+ * never, or 150 ticks later, past the timeout. Every call must end on the
+ * exact tick its reply or its timeout is due, with the right outcome, and a
+ * late reply must be refused.
+ *
+ *   SRC="src/os_sys.c src/os_task.c src/os_clock.c src/os_timer.c src/os_critical.c \
+ *        src/os_msg.c src/os_rpc.c src/umm_malloc/umm_malloc.c"
+ *   cc -O2 -Itools/sched_sim -Itools/msg_bench -Iinc -Isrc -I. \
+ *      -DOS_TICKLESS_EN -DOS_MSG_EN -DOS_MEM_EN -DOS_POST_EN -DOS_RPC_EN \
+ *      -o rpc_sim tools/sched_sim/rpc_sim.c tools/sched_sim/board.c $SRC
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "os.h"
+
+#define SIM_CALLS           20000uL
+#define SIM_TIMEOUT         100
+
+#define SIM_CLIENT          0
+#define SIM_SERVER          1
+
+#define CLIENT_EVT_CALL     0
+#define CLIENT_EVT_REPLY    1
+#define SERVER_EVT_LATER    SIM_ANSWER_LATER
+#define SERVER_EVT_LATE     SIM_ANSWER_LATE
+
+#define SIM_ANSWER_NOW      0
+#define SIM_ANSWER_LATER    1           // in time
+#define SIM_ANSWER_NEVER    2
+#define SIM_ANSWER_LATE     3           // after the timeout
+#define SIM_ANSWER_MAX      4
+
+static const os_uint32_t sim_answer_delay[SIM_ANSWER_MAX] = { 0, 40, SIM_TIMEOUT, 150 };
+
+typedef struct sim_req {
+    os_uint32_t seq;
+} SIM_REQ_t;
+
+static os_uint32_t sim_seq;
+static os_uint16_t sim_id;
+static os_uint32_t sim_due;
+static os_uint32_t sim_outcome[SIM_ANSWER_MAX];
+static os_uint32_t sim_refused;
+static SIM_REQ_t *sim_held[SIM_ANSWER_MAX];   // by the event answering it
+static os_uint32_t sim_seed = 11;
+
+static void sim_fail( const char *what )
+{
+    fprintf( stderr, "FAIL: call %lu %s at tick %lu, due %lu\n",
+             (unsigned long)sim_seq, what, (unsigned long)sim_time, (unsigned long)sim_due );
+    exit( 1 );
+}
+
+static void sim_finish( void )
+{
+    printf( "%lu calls in %lu ticks: %lu at once, %lu later, %lu never, %lu late (%lu replies refused), "
+            "%lu sleeps\n", (unsigned long)sim_seq, (unsigned long)sim_time,
+            (unsigned long)sim_outcome[SIM_ANSWER_NOW], (unsigned long)sim_outcome[SIM_ANSWER_LATER],
+            (unsigned long)sim_outcome[SIM_ANSWER_NEVER], (unsigned long)sim_outcome[SIM_ANSWER_LATE],
+            (unsigned long)sim_refused, (unsigned long)sim_sleeps );
+    if( sim_refused != sim_outcome[SIM_ANSWER_LATE] )
+    {
+        fprintf( stderr, "FAIL: late replies accepted\n" );
+        exit( 1 );
+    }
+    printf( "ok\n" );
+    exit( 0 );
+}
+
+static void client_task( os_int8_t event_id )
+{
+    SIM_REQ_t *p_req;
+    os_uint32_t *p_rsp;
+    os_uint8_t answer;
+    os_err_t err;
+
+    switch( event_id )
+    {
+    case CLIENT_EVT_CALL:
+        p_req = os_msg_create( sizeof(SIM_REQ_t), 0 );
+        OS_ASSERT( p_req != NULL );
+        p_req->seq = ++sim_seq;
+        answer = p_req->seq % SIM_ANSWER_MAX;
+        sim_due = sim_time + ( answer == SIM_ANSWER_LATE ? SIM_TIMEOUT : sim_answer_delay[answer] );
+        sim_id = os_rpc_call( SIM_SERVER, p_req, SIM_TIMEOUT, CLIENT_EVT_REPLY );
+        if( sim_id == 0 )
+        {
+            sim_fail( "refused" );
+        }
+        break;
+
+    case CLIENT_EVT_REPLY:
+        answer = sim_seq % SIM_ANSWER_MAX;
+        if( os_task_event_arg() != sim_id )
+        {
+            sim_fail( "answered with a stale id" );
+        }
+        if( sim_time != sim_due )
+        {
+            sim_fail( "ended off its tick" );
+        }
+        err = os_rpc_result( sim_id, (void **)&p_rsp );
+        if( answer == SIM_ANSWER_NOW || answer == SIM_ANSWER_LATER )
+        {
+            if( err != OS_ERR_NONE || p_rsp == NULL || *p_rsp != sim_seq )
+            {
+                sim_fail( "lost its reply" );
+            }
+            os_msg_delete( p_rsp );
+        }
+        else if( err != OS_ERR_TIMEOUT || p_rsp != NULL )
+        {
+            sim_fail( "did not time out" );
+        }
+        sim_outcome[answer]++;
+        if( os_rpc_result( sim_id, (void **)&p_rsp ) != OS_ERR_EMPTY )
+        {
+            sim_fail( "ended twice" );
+        }
+        if( sim_seq == SIM_CALLS )
+        {
+            sim_finish();
+        }
+        os_timer_create( SIM_CLIENT, CLIENT_EVT_CALL, 1 + sim_rand( &sim_seed ) % 300 );
+        break;
+    }
+}
+
+static void client_init( os_uint8_t task_id )
+{
+    os_timer_create( task_id, CLIENT_EVT_CALL, 1 );
+}
+
+static void server_reply( SIM_REQ_t *p_req )
+{
+    os_uint32_t *p_rsp;
+
+    p_rsp = os_msg_create( sizeof(os_uint32_t), 0 );
+    OS_ASSERT( p_rsp != NULL );
+    *p_rsp = p_req->seq;
+    if( os_rpc_reply( p_req, p_rsp ) != OS_ERR_NONE )
+    {
+        sim_refused++;
+    }
+    os_msg_delete( p_req );
+}
+
+static void server_task( os_int8_t event_id )
+{
+    SIM_REQ_t *p_req;
+
+    if( event_id == OS_TASK_EVT_MSG )
+    {
+        while( ( p_req = os_msg_recv( SIM_SERVER ) ) != NULL )
+        {
+            switch( p_req->seq % SIM_ANSWER_MAX )
+            {
+            case SIM_ANSWER_NOW:
+                server_reply( p_req );
+                break;
+            case SIM_ANSWER_NEVER:
+                os_msg_delete( p_req );
+                break;
+            default:
+                /* a late answer is still held when the next call comes */
+                sim_held[p_req->seq % SIM_ANSWER_MAX] = p_req;
+                os_timer_create( SIM_SERVER, p_req->seq % SIM_ANSWER_MAX, sim_answer_delay[p_req->seq % SIM_ANSWER_MAX] );
+                break;
+            }
+        }
+    }
+    else
+    {
+        OS_ASSERT( event_id == SERVER_EVT_LATER || event_id == SERVER_EVT_LATE );
+        server_reply( sim_held[event_id] );
+        sim_held[event_id] = NULL;
+    }
+}
+
+static OS_POST_t client_post[2];
+
+static const OS_TASK_t sim_task_array[] = {
+    { .p_task_init = client_init, .p_task_handler = client_task, OS_POST_SLOTS(client_post) },
+    { .p_task_handler = server_task },
+};
+SIM_TASK_TABLE( sim_task_array );
+
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
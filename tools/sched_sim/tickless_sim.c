@@ -0,0 +1,194 @@
+/*******************************************************************************
+ * Copyright (c) 2021-2022, PEOS Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date         Author       Notes
+ * 2026-10-17   PEOS Team    first version
+ *
+ ******************************************************************************/
+
+/*
+ * Timer expiry accuracy with and without tickless idle. The real scheduler
+ * runs on the simulated board. Four tasks re-arm their timer with random
+ * periods, from a few ticks to longer than one sleep may last, and an
+ * interrupt ends one sleep in eight early. Every expiry must be dispatched
+ * on the tick it is due, and os_systick and os_clock_get() must match the
+ * ticks really passed. Build and run it both ways, the results must match
+ * apart from the sleep counts.
+ *
+ * With -DOS_DEFER_EN as well, the interrupt also queues deferred work that
+ * takes a tick. That tick passes after the clock update of its pass, and
+ * the sleep that ends the pass must not count it twice. An expiry may only
+ * run late by the ticks of work started on or after its tick. Build it
+ * tickless, the periodic idle waits for the next tick like the hardware does.
+ *
+ *   SRC="src/os_sys.c src/os_task.c src/os_clock.c src/os_timer.c src/os_critical.c"
+ *   cc -O2 -Itools/sched_sim -Itools/msg_bench -Iinc -Isrc -I. \
+ *      -o tickless_sim tools/sched_sim/tickless_sim.c tools/sched_sim/board.c $SRC
+ *   cc -O2 -Itools/sched_sim -Itools/msg_bench -Iinc -Isrc -I. -DOS_TICKLESS_EN \
+ *      -o tickless_sim_on tools/sched_sim/tickless_sim.c tools/sched_sim/board.c $SRC
+ *   cc -O2 -Itools/sched_sim -Itools/msg_bench -Iinc -Isrc -I. -DOS_TICKLESS_EN -DOS_DEFER_EN \
+ *      -o tickless_sim_busy tools/sched_sim/tickless_sim.c tools/sched_sim/board.c $SRC src/os_defer.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "os.h"
+
+#define SIM_RUN             2000000uL   // ticks simulated
+#define SIM_EVT_TIMER       0
+#define SIM_TASKS           4
+
+extern volatile os_uint32_t os_systick;
+#ifdef OS_TICKLESS_EN
+extern os_uint32_t __os_clock_pending( void );
+#endif
+
+static const os_uint32_t sim_period_min[SIM_TASKS] = { 1, 1, 100, 60000 };
+static const os_uint32_t sim_period_max[SIM_TASKS] = { 10, 600, 5000, 70000 };
+static os_uint32_t sim_due[SIM_TASKS];
+static os_uint32_t sim_fires;
+static os_uint32_t sim_late;
+static os_uint32_t sim_irqs;
+#ifdef OS_DEFER_EN
+static os_uint32_t sim_busy_ticks;
+static os_uint32_t sim_busy_at[16];         // ticks the latest deferred work started on
+#endif
+static os_uint32_t sim_seed = 7;
+
+static void sim_arm( os_uint8_t index )
+{
+    os_uint32_t period;
+
+    period = sim_period_min[index] + sim_rand( &sim_seed ) % ( sim_period_max[index] - sim_period_min[index] + 1 );
+    /* a timer counts from the last clock update, not from ticks still pending */
+    sim_due[index] = sim_time + period;
+#ifdef OS_TICKLESS_EN
+    sim_due[index] -= __os_clock_pending();
+#endif
+    if( os_timer_create( index + 1, SIM_EVT_TIMER, period ) != OS_ERR_NONE )
+    {
+        fprintf( stderr, "FAIL: no timer\n" );
+        exit( 1 );
+    }
+}
+
+static void sim_finish( void )
+{
+    OS_CLOCK_t clock;
+
+    os_clock_get( &clock );
+    printf( "%lu ticks, %lu expiries, %lu late, %lu interrupts, %lu sleeps for %lu ticks\n",
+            (unsigned long)sim_time, (unsigned long)sim_fires, (unsigned long)sim_late,
+            (unsigned long)sim_irqs, (unsigned long)sim_sleeps, (unsigned long)sim_slept );
+#ifdef OS_DEFER_EN
+    printf( "%lu ticks in deferred work\n", (unsigned long)sim_busy_ticks );
+#endif
+    if( os_systick != sim_time || clock.tick[0] != sim_time || clock.tick[1] != 0 )
+    {
+        fprintf( stderr, "FAIL: os_systick %lu, clock %lu after %lu ticks\n",
+                 (unsigned long)os_systick, (unsigned long)clock.tick[0], (unsigned long)sim_time );
+        exit( 1 );
+    }
+    if( sim_late )
+    {
+        fprintf( stderr, "FAIL: %lu expiries off their tick\n", (unsigned long)sim_late );
+        exit( 1 );
+    }
+    printf( "ok\n" );
+    exit( 0 );
+}
+
+/* task 0, woken by the simulated interrupt */
+static void sim_irq_task( os_int8_t event_id )
+{
+    (void)event_id;
+    sim_irqs++;
+}
+
+#ifdef OS_DEFER_EN
+/* deferred work that runs across a tick */
+static void sim_busy( os_uint32_t arg )
+{
+    (void)arg;
+    sim_busy_at[sim_busy_ticks++ % 16] = sim_time;
+    sim_tick();
+}
+#endif
+
+static void sim_irq( void )
+{
+#ifdef OS_DEFER_EN
+    static os_uint8_t defer_only;
+
+    /* work with no task readied, the pass that runs it goes on to sleep */
+    (void)os_defer( 0, sim_busy, 0 );
+    defer_only = !defer_only;
+    if( defer_only )
+        return;
+#endif
+    os_task_set_event( 0, 0 );
+}
+
+static void sim_timer_init( os_uint8_t task_id )
+{
+    sim_arm( task_id - 1 );
+    if( task_id == SIM_TASKS )
+    {
+        sim_irq_hook( sim_irq, 8 );
+    }
+}
+
+/* ticks taken by deferred work started on or after tick */
+static os_uint32_t sim_busy_since( os_uint32_t tick )
+{
+#ifdef OS_DEFER_EN
+    os_uint32_t count = 0;
+    os_uint32_t i;
+
+    for( i = 0; i < 16 && i < sim_busy_ticks; i++ )
+    {
+        if( sim_busy_at[i] >= tick )
+            count++;
+    }
+    return count;
+#else
+    (void)tick;
+    return 0;
+#endif
+}
+
+static void sim_timer_task( os_int8_t event_id )
+{
+    os_uint8_t index = os_get_task_id_self() - 1;
+
+    (void)event_id;
+    OS_ASSERT( event_id == SIM_EVT_TIMER );
+    sim_fires++;
+    if( sim_time != sim_due[index] + sim_busy_since( sim_due[index] ) )
+    {
+        if( sim_late++ < 10 )
+        {
+            fprintf( stderr, "task %u due at %lu, ran at %lu\n", (unsigned)index + 1,
+                     (unsigned long)sim_due[index], (unsigned long)sim_time );
+        }
+    }
+    if( sim_time >= SIM_RUN )
+    {
+        sim_finish();
+    }
+    sim_arm( index );
+}
+
+static const OS_TASK_t sim_task_array[] = {
+    { .p_task_handler = sim_irq_task },
+    { .p_task_init = sim_timer_init, .p_task_handler = sim_timer_task },
+    { .p_task_init = sim_timer_init, .p_task_handler = sim_timer_task },
+    { .p_task_init = sim_timer_init, .p_task_handler = sim_timer_task },
+    { .p_task_init = sim_timer_init, .p_task_handler = sim_timer_task },
+};
+SIM_TASK_TABLE( sim_task_array );
+
+/****** (C) COPYRIGHT 2021 PEOS Development Team. *****END OF FILE****/
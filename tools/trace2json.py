@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+# Copyright (c) 2021-2022, PEOS Development Team
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Converts a PEOS trace dump, as sent by the CLI "trace" command, into the
+# Chrome trace event JSON that chrome://tracing and ui.perfetto.dev load.
+#
+#   trace2json.py capture.bin [trace.json]
+#
+# The capture may hold other terminal output around the dump, everything
+# before the "PEOT" magic is skipped.
+
+import json
+import struct
+import sys
+
+MAGIC = b"PEOT"
+VERSION = 1
+
+DISPATCH_BEGIN = 0
+DISPATCH_END = 1
+EVENT_SET = 2
+EVENT_SET_ISR = 3
+TIMER_FIRE = 4
+MSG_SEND = 5
+MSG_RECV = 6
+ALLOC = 7
+FREE = 8
+POST = 9
+
+EVT_MSG = -1
+EVT_MBOX = -2
+
+
+def event_name(arg):
+    event_id = arg - 0x10000 if arg & 0x8000 else arg
+    if event_id == EVT_MSG:
+        return "msg"
+    if event_id == EVT_MBOX:
+        return "mbox"
+    return "evt %d" % event_id
+
+
+def parse(data):
+    start = data.find(MAGIC)
+    if start < 0:
+        raise ValueError("no PEOT header in the capture")
+    version, rec_size, count, hz = struct.unpack_from("<BBHI", data, start + 4)
+    if version != VERSION or rec_size != 8:
+        raise ValueError("unsupported trace version %d, record size %d" % (version, rec_size))
+    body = start + 12
+    if len(data) < body + count * rec_size:
+        raise ValueError("capture ends after %d of %d records" % ((len(data) - body) // rec_size, count))
+    records = [struct.unpack_from("<IBBH", data, body + i * rec_size) for i in range(count)]
+    return hz, records
+
+
+def convert(hz, records):
+    events = []
+    heap = 0
+    base = None
+    prev = None
+    wraps = 0
+
+    for time, kind, task_id, arg in records:
+        # the 32-bit time stamp wraps, records are in order
+        if prev is not None and time < prev:
+            wraps += 1
+        prev = time
+        time += wraps << 32
+        if base is None:
+            base = time
+        ts = (time - base) * 1e6 / hz
+
+        common = {"pid": 0, "tid": task_id, "ts": ts}
+        if kind == DISPATCH_BEGIN:
+            events.append(dict(common, ph="B", name=event_name(arg)))
+        elif kind == DISPATCH_END:
+            events.append(dict(common, ph="E", name=event_name(arg)))
+        elif kind in (EVENT_SET, EVENT_SET_ISR):
+            events.append(dict(common, ph="i", s="t", name="set " + event_name(arg),
+                               args={"isr": kind == EVENT_SET_ISR}))
+        elif kind == TIMER_FIRE:
+            events.append(dict(common, ph="i", s="t", name="timer " + event_name(arg)))
+        elif kind == POST:
+            events.append(dict(common, ph="i", s="t", name="post " + event_name(arg)))
+        elif kind in (MSG_SEND, MSG_RECV):
+            events.append(dict(common, ph="i", s="t",
+                               name="msg send" if kind == MSG_SEND else "msg recv",
+                               args={"len": arg}))
+        elif kind in (ALLOC, FREE):
+            heap += arg if kind == ALLOC else -arg
+            events.append({"pid": 0, "ts": ts, "ph": "C", "name": "heap", "args": {"bytes": heap}})
+        else:
+            events.append(dict(common, ph="i", s="t", name="type %d" % kind, args={"arg": arg}))
+
+    for task_id in sorted({rec[2] for rec in records}):
+        events.append({"pid": 0, "tid": task_id, "ph": "M", "name": "thread_name",
+                       "args": {"name": "task %d" % task_id}})
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write("usage: %s capture.bin [trace.json]\n" % argv[0])
+        return 2
+    with open(argv[1], "rb") as f:
+        hz, records = parse(f.read())
+    out = json.dumps(convert(hz, records), indent=1)
+    if len(argv) == 3:
+        with open(argv[2], "w") as f:
+            f.write(out)
+    else:
+        sys.stdout.write(out + "\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))